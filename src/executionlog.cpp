@@ -28,19 +28,16 @@
  * Contact : chris@qbittorrent.org
  */
 
-#include <QListWidgetItem>
-#include <QLabel>
 #include "executionlog.h"
 #include "ui_executionlog.h"
 #include "iconprovider.h"
 #include "loglistwidget.h"
-#include "transport/session.h"
 
 ExecutionLog::ExecutionLog(QWidget *parent) :
   QWidget(parent),
   ui(new Ui::ExecutionLog),
-  m_logList(new LogListWidget(MAX_LOG_MESSAGES)),
-  m_banList(new LogListWidget(MAX_LOG_MESSAGES))
+  m_logList(new LogListWidget(SessionLog::J_CONSOLE)),
+  m_banList(new LogListWidget(SessionLog::J_BAN))
 {
     ui->setupUi(this);
 
@@ -48,15 +45,6 @@ ExecutionLog::ExecutionLog(QWidget *parent) :
     ui->tabConsole->setTabIcon(1, IconProvider::instance()->getIcon("view-filter"));
     ui->tabGeneral->layout()->addWidget(m_logList);
     ui->tabBan->layout()->addWidget(m_banList);
-
-    const QStringList log_msgs = Session::instance()->getConsoleMessages();
-    foreach (const QString& msg, log_msgs)
-      addLogMessage(msg);
-    const QStringList ban_msgs = Session::instance()->getPeerBanMessages();
-    foreach (const QString& msg, ban_msgs)
-      addBanMessage(msg);
-    connect(Session::instance(), SIGNAL(newConsoleMessage(QString)), SLOT(addLogMessage(QString)));
-    connect(Session::instance(), SIGNAL(newBanMessage(QString)), SLOT(addBanMessage(QString)));
 }
 
 ExecutionLog::~ExecutionLog()
@@ -65,13 +53,3 @@ ExecutionLog::~ExecutionLog()
   delete m_banList;
   delete ui;
 }
-
-void ExecutionLog::addLogMessage(const QString &msg)
-{
-  m_logList->appendLine(msg);
-}
-
-void ExecutionLog::addBanMessage(const QString &msg)
-{
-  m_banList->appendLine(msg);
-}
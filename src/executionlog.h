@@ -48,16 +48,11 @@ public:
     explicit ExecutionLog(QWidget *parent = 0);
     ~ExecutionLog();
 
-public slots:
-  void addLogMessage(const QString &msg);
-  void addBanMessage(const QString &msg);
-
 private:
   Ui::ExecutionLog *ui;
 
   LogListWidget *m_logList;
   LogListWidget *m_banList;
-  int m_maxLines;
 };
 
 #endif // EXECUTIONLOG_H
@@ -3,6 +3,7 @@
 #include <QPainter>
 #include <QClipboard>
 #include <QDesktopServices>
+#include <QProgressDialog>
 
 #include "files_widget.h"
 #include "session_fs_models/file_model.h"
@@ -11,6 +12,7 @@
 #include "session_fs_models/path_model.h"
 #include "session_fs_models/shared_files_model.h"
 #include "transport/session.h"
+#include "transport/share_transaction.h"
 
 #include <libed2k/file.hpp>
 
@@ -245,10 +247,8 @@ void files_widget::exchangeSubdir()
 
     if (indx.isValid())
     {
-       QApplication::setOverrideCursor(Qt::WaitCursor);
        qDebug() << "call shareDirectoryR";
-       static_cast<FileNode*>(indx.internalPointer())->share(true);
-       QApplication::restoreOverrideCursor();
+       startTransaction(static_cast<DirNode*>(indx.internalPointer()), true);
     }
 }
 
@@ -271,13 +271,45 @@ void files_widget::unxchangeSubdir()
 
     if (indx.isValid())
     {
-       QApplication::setOverrideCursor(Qt::WaitCursor);
        qDebug() << "call unshareDirectoryR";
-       static_cast<FileNode*>(indx.internalPointer())->unshare(true);
-       QApplication::restoreOverrideCursor();
+       startTransaction(static_cast<DirNode*>(indx.internalPointer()), false);
+    }
+}
+
+void files_widget::startTransaction(DirNode* node, bool share)
+{
+    ShareTransaction* transaction = Session::instance()->shareTransaction(node, share);
+
+    QProgressDialog* dlg = new QProgressDialog(this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose);
+    dlg->setWindowTitle(share?tr("Exchange subdirectories"):tr("Unexchange subdirectories"));
+    dlg->setLabelText(node->filepath());
+    dlg->setRange(0, 0);
+    dlg->setMinimumDuration(500);
+    dlg->setWindowModality(Qt::NonModal);
+
+    connect(transaction, SIGNAL(progress(int, int)), this, SLOT(transactionProgress(int, int)));
+    connect(transaction, SIGNAL(finished()), dlg, SLOT(close()));
+    connect(dlg, SIGNAL(canceled()), transaction, SLOT(cancel()));
+    m_transactions.insert(transaction, dlg);
+    connect(transaction, SIGNAL(finished()), this, SLOT(transactionFinished()));
+}
+
+void files_widget::transactionProgress(int dirs, int files)
+{
+    QProgressDialog* dlg = m_transactions.value(qobject_cast<ShareTransaction*>(sender()));
+
+    if (dlg)
+    {
+        dlg->setLabelText(tr("Processed directories: %1, files: %2").arg(dirs).arg(files));
     }
 }
 
+void files_widget::transactionFinished()
+{
+    m_transactions.remove(qobject_cast<ShareTransaction*>(sender()));
+}
+
 void files_widget::reloadDir()
 {
     QModelIndex indx = sort2dir(treeView->selectionModel()->currentIndex());
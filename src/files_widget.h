@@ -6,6 +6,8 @@
 #include <QSplitter>
 #include <QItemSelection>
 #include <QSortFilterProxyModel>
+#include <QPointer>
+#include <QHash>
 #include "ui_files_widget.h"
 #include "misc.h"
 
@@ -17,6 +19,9 @@ class SFModel;
 class SessionFilesSort;
 class SessionDirectoriesSort;
 class PathsSort;
+class DirNode;
+class ShareTransaction;
+class QProgressDialog;
 
 class files_widget : public QWidget, public Ui::files_widget
 {
@@ -46,6 +51,7 @@ private:
 
     SessionFilesSort* m_sort_files_model;
     SessionDirectoriesSort* m_sort_dirs_model;
+    QHash<ShareTransaction*, QPointer<QProgressDialog> > m_transactions;
     QModelIndex sort2dir(const QModelIndex& index) const;
     QModelIndex sort2file(const QModelIndex& index) const;
     QModelIndex sort2dir_sum(const QModelIndex& index) const;
@@ -56,6 +62,7 @@ private:
     QStringList generateLinks();        // files browser
     QStringList generateLinksSum();     // summary browser
     QStringList generateLinksByTab();   // for 0 files, for 1 summary
+    void startTransaction(DirNode* node, bool share);
 public slots:
     void putToClipboard();
 private slots:
@@ -88,6 +95,8 @@ private slots:
     void openSelectedSumFile();
     void on_treeView_expanded(const QModelIndex &index);
     void on_treeView_collapsed(const QModelIndex &index);
+    void transactionProgress(int dirs, int files);
+    void transactionFinished();
 };
 
 #endif // FILES_WIDGET_H
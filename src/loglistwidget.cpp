@@ -30,17 +30,110 @@
 #include <QKeyEvent>
 #include <QApplication>
 #include <QClipboard>
-#include <QListWidgetItem>
-#include <QLabel>
-#include <QRegExp>
+#include <QPainter>
+#include <QTextDocument>
 #include <QAction>
 #include "loglistwidget.h"
 #include "iconprovider.h"
 
-LogListWidget::LogListWidget(int max_lines, QWidget *parent) :
-  QListWidget(parent),
-  m_maxLines(max_lines)
+LogModel::LogModel(SessionLog::Journal journal, QObject *parent) :
+  QAbstractListModel(parent),
+  m_journal(journal),
+  m_pending(0)
 {
+  const LogRing& ring = SessionLog::instance()->journal(m_journal);
+  m_rows = ring.size();
+  m_seen = ring.total();
+  connect(SessionLog::instance(), SIGNAL(recordsAdded(int)), SLOT(addRecords(int)));
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : m_rows;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || index.row() >= m_rows)
+    return QVariant();
+
+  switch (role) {
+  case Qt::DisplayRole:
+    return SessionLog::text(record(index.row()));
+  case Qt::UserRole:
+    return SessionLog::html(record(index.row()));
+  default:
+    return QVariant();
+  }
+}
+
+const LogRecord& LogModel::record(int row) const
+{
+  const LogRing& ring = SessionLog::instance()->journal(m_journal);
+  return ring.at(ring.size() - 1 - m_pending - row);
+}
+
+void LogModel::addRecords(int journal)
+{
+  if (journal != m_journal)
+    return;
+
+  const LogRing& ring = SessionLog::instance()->journal(m_journal);
+  // Records overwritten before we were notified are never shown
+  const int added = static_cast<int>(qMin<quint64>(ring.total() - m_seen, ring.size()));
+  m_seen = ring.total();
+  if (added == 0)
+    return;
+
+  // Old rows keep pointing to their records while rows are removed
+  m_pending = added;
+  const int removed = m_rows + added - ring.size();
+  if (removed > 0) {
+    beginRemoveRows(QModelIndex(), m_rows - removed, m_rows - 1);
+    m_rows -= removed;
+    endRemoveRows();
+  }
+
+  beginInsertRows(QModelIndex(), 0, added - 1);
+  m_rows += added;
+  m_pending = 0;
+  endInsertRows();
+}
+
+void LogItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+  QStyleOptionViewItemV4 opt = option;
+  initStyleOption(&opt, index);
+  opt.text.clear();
+  // Background and selection
+  QStyle *style = opt.widget ? opt.widget->style() : QApplication::style();
+  style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+  QTextDocument doc;
+  doc.setDocumentMargin(0);
+  doc.setHtml(index.data(Qt::UserRole).toString());
+  painter->save();
+  painter->translate(opt.rect.left() + 4, opt.rect.top() + 2);
+  doc.drawContents(painter, QRectF(0, 0, opt.rect.width() - 4, opt.rect.height() - 2));
+  painter->restore();
+}
+
+QSize LogItemDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const
+{
+  Q_UNUSED(option);
+  QTextDocument doc;
+  doc.setDocumentMargin(0);
+  doc.setHtml(index.data(Qt::UserRole).toString());
+  return QSize(doc.idealWidth() + 8, doc.size().height() + 4);
+}
+
+LogListWidget::LogListWidget(SessionLog::Journal journal, QWidget *parent) :
+  QListView(parent)
+{
+  setModel(new LogModel(journal, this));
+  setItemDelegate(new LogItemDelegate(this));
+  // Lines have same height, size hint of first one is enough
+  setUniformItemSizes(true);
   // Allow multiple selections
   setSelectionMode(QAbstractItemView::ExtendedSelection);
   // Context menu
@@ -62,28 +155,13 @@ void LogListWidget::keyPressEvent(QKeyEvent *event)
   }
 }
 
-void LogListWidget::appendLine(const QString &line)
-{
-  QListWidgetItem *item = new QListWidgetItem;
-  // We need to use QLabel here to support rich text
-  QLabel *lbl = new QLabel(line);
-  lbl->setContentsMargins(4, 2, 4, 2);
-  item->setSizeHint(lbl->sizeHint());
-  insertItem(0, item);
-  setItemWidget(item, lbl);
-  const int nbLines = count();
-  // Limit log size
-  if (nbLines > m_maxLines)
-    delete takeItem(nbLines - 1);
-}
-
 void LogListWidget::copySelection()
 {
-  static QRegExp html_tag("<[^>]+>");
-  QList<QListWidgetItem*> items = selectedItems();
+  QModelIndexList indexes = selectionModel()->selectedIndexes();
+  qSort(indexes);
   QStringList strings;
-  foreach (QListWidgetItem* it, items)
-    strings << static_cast<QLabel*>(itemWidget(it))->text().replace(html_tag, "");
+  foreach (const QModelIndex &index, indexes)
+    strings << index.data().toString();
 
   QApplication::clipboard()->setText(strings.join("\n"));
 }
@@ -30,21 +30,56 @@
 #ifndef LOGLISTWIDGET_H
 #define LOGLISTWIDGET_H
 
-#include <QListWidget>
+#include <QListView>
+#include <QAbstractListModel>
+#include <QStyledItemDelegate>
+#include "transport/session_log.h"
 
 QT_BEGIN_NAMESPACE
 class QKeyEvent;
 QT_END_NAMESPACE
 
-class LogListWidget : public QListWidget
+// Journal of SessionLog, newest record first.
+// Display role is plain text, html is made in UserRole for painted rows only
+class LogModel : public QAbstractListModel
 {
-    Q_OBJECT
+  Q_OBJECT
 
 public:
-  explicit LogListWidget(int max_lines = 100, QWidget *parent = 0);
+  explicit LogModel(SessionLog::Journal journal, QObject *parent = 0);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+private slots:
+  void addRecords(int journal);
+
+private:
+  const LogRecord& record(int row) const;
 
-public slots:
-  void appendLine(const QString &line);
+  SessionLog::Journal m_journal;
+  int m_rows;
+  int m_pending; // records in ring which are not inserted yet
+  quint64 m_seen;
+};
+
+class LogItemDelegate : public QStyledItemDelegate
+{
+  Q_OBJECT
+
+public:
+  explicit LogItemDelegate(QObject *parent = 0) : QStyledItemDelegate(parent) {}
+
+  void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const;
+  QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const;
+};
+
+class LogListWidget : public QListView
+{
+    Q_OBJECT
+
+public:
+  explicit LogListWidget(SessionLog::Journal journal, QWidget *parent = 0);
 
 protected slots:
   void copySelection();
@@ -52,9 +87,6 @@ protected slots:
 protected:
   void keyPressEvent(QKeyEvent *event);
 
-private:
-  int m_maxLines;
-
 };
 
 #endif // LOGLISTWIDGET_H
@@ -62,6 +62,7 @@
 #include <stdlib.h>
 #include "misc.h"
 #include "preferences.h"
+#include "transport/session_log.h"
 
 class UsageDisplay: public QObject {
   Q_OBJECT
@@ -73,6 +74,7 @@ public:
 #ifndef DISABLE_GUI
     std::cout << '\t' << prg_name << " --no-splash: " << qPrintable(tr("disable splash screen")) << std::endl;
 #endif
+    std::cout << '\t' << prg_name << " --log-file=<path>: " << qPrintable(tr("appends log messages to file")) << std::endl;
     std::cout << '\t' << prg_name << " --help: " << qPrintable(tr("displays this help message")) << std::endl;    
     std::cout << '\t' << prg_name << " " << qPrintable(tr("[files or urls]: downloads the torrents passed by the user (optional)")) << std::endl;
   }
@@ -240,6 +242,12 @@ int main(int argc, char *argv[]) {
   no_splash = !al.filter(QRegExp("^-+no-splash$")).isEmpty();
 #endif
 
+  QStringList log_file = al.filter(QRegExp("^-+log-file=.+$"));
+  if (!log_file.isEmpty())
+  {
+    SessionLog::instance()->setFileSink(log_file.last().section('=', 1, -1));
+  }
+
   QSplashScreen *splash = 0;
 #ifndef DISABLE_GUI
   if (pref.isSlashScreenDisabled())
@@ -299,6 +307,9 @@ int main(int argc, char *argv[]) {
   LOGGER_INIT(LOG_ALL)
 
   int ret = app.exec();
+#ifdef DISABLE_GUI
+  SessionLog::drop();
+#endif
   qDebug("Application has exited");
   return ret;
 }
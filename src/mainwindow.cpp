@@ -67,6 +67,7 @@
 #include "torrentimportdlg.h"
 #include "executionlog.h"
 #include "iconprovider.h"
+#include "file_type_provider.h"
 #include "status_widget.h"
 #include "search_widget.h"
 #include "messages_widget.h"
@@ -334,7 +335,7 @@ MainWindow::MainWindow(QSplashScreen* sscrn, QWidget *parent, QStringList torren
   connect(Session::instance()->get_ed2k_session(), SIGNAL(serverIdentity(QString, QString)), this, SLOT(ed2kIdentity(QString, QString)));
   connect(Session::instance()->get_ed2k_session(), SIGNAL(serverConnectionClosed(QString)), this, SLOT(ed2kConnectionClosed(QString)));
 
-  connect(Session::instance(), SIGNAL(newConsoleMessage(const QString&)), status, SLOT(addHtmlLogMessage(const QString&)));
+  connect(SessionLog::instance(), SIGNAL(recordsAdded(int)), status, SLOT(addConsoleRecords(int)));
 
   //Tray actions.
   connect(actionToggleVisibility, SIGNAL(triggered()), this, SLOT(toggleVisibility()));
@@ -394,6 +395,7 @@ MainWindow::~MainWindow()
   delete hideShortcut;
 
   IconProvider::drop();
+  FileTypeProvider::drop();
   // Delete Session::instance() object
   m_pwr->setActivityState(false);
   qDebug() << "Saving session filesystem";
@@ -401,6 +403,7 @@ MainWindow::~MainWindow()
   Session::instance()->saveFileSystem();
   qDebug("Deleting Session::instance()");
   Session::drop();    
+  SessionLog::drop();
   qDebug("Exiting GUI destructor...");
 }
 
@@ -0,0 +1,164 @@
+#include "natural_sort.h"
+
+static const QChar number_marker = QChar(0xFFFF); // noncharacter, never appears in filenames
+
+static QChar getNextChar(const QString &s, int location)
+{
+    return (location < s.length()) ? s.at(location) : QChar();
+}
+
+int naturalCompare(const QString &s1, const QString &s2,  Qt::CaseSensitivity cs)
+{
+    for (int l1 = 0, l2 = 0; l1 <= s1.count() && l2 <= s2.count(); ++l1, ++l2) {
+        // skip spaces, tabs and 0's
+        QChar c1 = getNextChar(s1, l1);
+        while (c1.isSpace())
+            c1 = getNextChar(s1, ++l1);
+        QChar c2 = getNextChar(s2, l2);
+        while (c2.isSpace())
+            c2 = getNextChar(s2, ++l2);
+
+        if (c1.isDigit() && c2.isDigit()) {
+            while (c1.digitValue() == 0)
+                c1 = getNextChar(s1, ++l1);
+            while (c2.digitValue() == 0)
+                c2 = getNextChar(s2, ++l2);
+
+            int lookAheadLocation1 = l1;
+            int lookAheadLocation2 = l2;
+            int currentReturnValue = 0;
+            // find the last digit, setting currentReturnValue as we go if it isn't equal
+            for (
+                QChar lookAhead1 = c1, lookAhead2 = c2;
+                (lookAheadLocation1 <= s1.length() && lookAheadLocation2 <= s2.length());
+                lookAhead1 = getNextChar(s1, ++lookAheadLocation1),
+                lookAhead2 = getNextChar(s2, ++lookAheadLocation2)
+                ) {
+                bool is1ADigit = !lookAhead1.isNull() && lookAhead1.isDigit();
+                bool is2ADigit = !lookAhead2.isNull() && lookAhead2.isDigit();
+                if (!is1ADigit && !is2ADigit)
+                    break;
+                if (!is1ADigit)
+                    return -1;
+                if (!is2ADigit)
+                    return 1;
+                if (currentReturnValue == 0) {
+                    if (lookAhead1 < lookAhead2) {
+                        currentReturnValue = -1;
+                    } else if (lookAhead1 > lookAhead2) {
+                        currentReturnValue = 1;
+                    }
+                }
+            }
+            if (currentReturnValue != 0)
+                return currentReturnValue;
+        }
+
+        if (cs == Qt::CaseInsensitive) {
+            if (!c1.isLower()) c1 = c1.toLower();
+            if (!c2.isLower()) c2 = c2.toLower();
+        }
+        int r = QString::localeAwareCompare(c1, c2);
+        if (r < 0)
+            return -1;
+        if (r > 0)
+            return 1;
+    }
+    // The two strings are the same (02 == 2) so fall back to the normal sort
+    return QString::compare(s1, s2, cs);
+}
+
+
+
+QString naturalKey(const QString& s)
+{
+    QString key;
+    key.reserve(s.size() + 4);
+    int i = 0;
+
+    while (i < s.size())
+    {
+        QChar c = s.at(i);
+
+        if (c.isSpace())
+        {
+            ++i;
+            continue;
+        }
+
+        if (c.isDigit())
+        {
+            const int first = i;
+            int start = i;
+            while (i < s.size() && s.at(i).isDigit()) ++i;
+            // keep last zero when run contains zeros only
+            while (start < i - 1 && s.at(start).digitValue() == 0) ++start;
+            key += number_marker;
+            key += QChar(ushort(i - start));
+            // naturalCompare compares number against character by first digit as written
+            key += s.at(first);
+            key += s.midRef(start, i - start);
+            // naturalCompare skips trailing zeros of equal numbers and lands on the next
+            // character without skipping spaces, so this space counts
+            if (s.at(i - 1).digitValue() == 0 && i < s.size() && s.at(i).isSpace())
+            {
+                key += s.at(i);
+                ++i;
+            }
+            continue;
+        }
+
+        key += c;
+        ++i;
+    }
+
+    return key;
+}
+
+int naturalKeyCompare(const QString& k1, const QString& k2)
+{
+    const QChar* p1 = k1.constData();
+    const QChar* p2 = k2.constData();
+    const QChar* e1 = p1 + k1.size();
+    const QChar* e2 = p2 + k2.size();
+
+    while (p1 < e1 && p2 < e2)
+    {
+        bool n1 = (*p1 == number_marker);
+        bool n2 = (*p2 == number_marker);
+
+        if (n1 && n2)
+        {
+            // longer number is greater, same length numbers compare by digits
+            ushort len1 = p1[1].unicode();
+            ushort len2 = p2[1].unicode();
+            if (len1 != len2) return (len1 < len2)?-1:1;
+
+            for (ushort i = 0; i < len1; ++i)
+            {
+                if (p1[3 + i] != p2[3 + i]) return (p1[3 + i] < p2[3 + i])?-1:1;
+            }
+
+            p1 += 3 + len1;
+            p2 += 3 + len2;
+            continue;
+        }
+
+        // number against character compares by first digit as written, leading zero included
+        QChar c1 = n1?p1[2]:*p1;
+        QChar c2 = n2?p2[2]:*p2;
+
+        if (c1 != c2)
+        {
+            int r = QString::localeAwareCompare(QString(c1), QString(c2));
+            if (r != 0) return (r < 0)?-1:1;
+        }
+
+        p1 += n1?(3 + p1[1].unicode()):1;
+        p2 += n2?(3 + p2[1].unicode()):1;
+    }
+
+    if (p1 < e1) return 1;
+    if (p2 < e2) return -1;
+    return 0;
+}
@@ -0,0 +1,25 @@
+#ifndef __NATURAL_SORT_H__
+#define __NATURAL_SORT_H__
+
+#include <QString>
+
+/**
+  * compare strings in natural order: spaces are ignored, digit runs compare as numbers
+ */
+int naturalCompare(const QString &s1, const QString &s2,  Qt::CaseSensitivity cs);
+
+/**
+  * precomputed key for case sensitive natural order
+  * spaces are dropped, every digit run is replaced by marker, run length,
+  * first digit as written and digits without leading zeros;
+  * space after number ending with zero is kept, as naturalCompare compares it
+ */
+QString naturalKey(const QString& s);
+
+/**
+  * compare keys were made by naturalKey
+  * equal keys mean equal strings in natural order, caller compares source strings then
+ */
+int naturalKeyCompare(const QString& k1, const QString& k2);
+
+#endif //__NATURAL_SORT_H__
@@ -29,10 +29,12 @@
  */
 
 #include "downloadedpiecesbar.h"
+#include "piecesscale.h"
+#include <cstring>
 
 //#include <QDebug>
 
-DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent): QWidget(parent)
+DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent): QWidget(parent), revision(0), image_revision(0)
 {
   setFixedHeight(BAR_HEIGHT);
 
@@ -44,93 +46,23 @@ DownloadedPiecesBar::DownloadedPiecesBar(QWidget *parent): QWidget(parent)
   updatePieceColors();
 }
 
-std::vector<float> DownloadedPiecesBar::bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize)
+bool DownloadedPiecesBar::equalBits(const libtorrent::bitfield &bf1, const libtorrent::bitfield &bf2)
 {
-  std::vector<float> result(reqSize, 0.0);
-
-  if (vecin.empty())
-    return result;
-
-  const float ratio = vecin.size() / (float)reqSize;
-
-  // simple linear transformation algorithm
-  // for example:
-  // image.x(0) = pieces.x(0.0 >= x < 1.7)
-  // image.x(1) = pieces.x(1.7 >= x < 3.4)
-
-  for (int x = 0; x < reqSize; ++x) {
-
-    // don't use previously calculated value "ratio" here!!!
-    // float cannot save irrational number like 7/9, if this number will be rounded up by std::ceil
-    // give you x2 == pieces.size(), and index out of range: pieces[x2]
-    // this code is safe, so keep that in mind when you try optimize more.
-    // tested with size = 3000000ul
-
-    // R - real
-    const float fromR = (x * vecin.size()) / (float)reqSize;
-    const float toR = ((x + 1) * vecin.size()) / (float)reqSize;
-
-    // C - integer
-    int fromC = fromR;// std::floor not needed
-    int toC = std::ceil(toR);
-
-    // position in pieces table
-    // libtorrent::bitfield::m_size is unsigned int(31 bits), so qlonglong is not needed
-    // tested with size = 3000000ul
-    int x2 = fromC;
-
-    // little speed up for really big pieces table, 10K+ size
-    const int toCMinusOne = toC - 1;
-
-    // value in returned vector
-    float value = 0;
-
-    // case when calculated range is (15.2 >= x < 15.7)
-    if (x2 == toCMinusOne) {
-      if (vecin[x2]) {
-        value += toR - fromR;
-      }
-      ++x2;
-    }
-    // case when (15.2 >= x < 17.8)
-    else {
-      // subcase (15.2 >= x < 16)
-      if (x2 != fromR) {
-        if (vecin[x2]) {
-          value += 1.0 - (fromR - fromC);
-        }
-        ++x2;
-      }
-
-      // subcase (16 >= x < 17)
-      for (; x2 < toCMinusOne; ++x2) {
-        if (vecin[x2]) {
-          value += 1.0;
-        }
-      }
-
-      // subcase (17 >= x < 17.8)
-      if (x2 == toCMinusOne) {
-        if (vecin[x2]) {
-          value += 1.0 - (toC - toR);
-        }
-        ++x2;
-      }
-    }
-
-    // normalization <0, 1>
-    value /= ratio;
-
-    // float precision sometimes gives > 1, because in not possible to store irrational numbers
-    value = qMin(value, (float)1.0);
-
-    result[x] = value;
-  }
-
-  return result;
+  if (bf1.size() != bf2.size())
+    return false;
+  if (bf1.empty())
+    return true;
+  // whole bytes, then used bits of last byte
+  const int full = bf1.size() / 8;
+  if (memcmp(bf1.bytes(), bf2.bytes(), full) != 0)
+    return false;
+  const int tail = bf1.size() % 8;
+  if (tail == 0)
+    return true;
+  const unsigned char mask = 0xff << (8 - tail);
+  return ((bf1.bytes()[full] ^ bf2.bytes()[full]) & mask) == 0;
 }
 
-
 int DownloadedPiecesBar::mixTwoColors(int &rgb1, int &rgb2, float ratio)
 {
   int r1 = qRed(rgb1);
@@ -154,15 +86,16 @@ void DownloadedPiecesBar::updateImage()
   //  qDebug() << "updateImage";
   QImage image2(width() - 2, 1, QImage::Format_RGB888);
 
+  image_revision = revision;
+
   if (pieces.empty()) {
     image2.fill(0xffffff);
     image = image2;
-    update();
     return;
   }
 
-  std::vector<float> scaled_pieces = bitfieldToFloatVector(pieces, image2.width());
-  std::vector<float> scaled_pieces_dl = bitfieldToFloatVector(pieces_dl, image2.width());
+  std::vector<float> scaled_pieces = scaleBitfield(pieces, image2.width());
+  std::vector<float> scaled_pieces_dl = scaleBitfield(pieces_dl, image2.width());
 
   // filling image
   for (unsigned int x = 0; x < scaled_pieces.size(); ++x)
@@ -189,10 +122,14 @@ void DownloadedPiecesBar::updateImage()
 
 void DownloadedPiecesBar::setProgress(const libtorrent::bitfield &bf, const libtorrent::bitfield &bf_dl)
 {
+  if (equalBits(bf, pieces) && equalBits(bf_dl, pieces_dl))
+    return;
+
   pieces = libtorrent::bitfield(bf);
   pieces_dl = libtorrent::bitfield(bf_dl);
 
-  updateImage();
+  // image is rebuilt on paint
+  ++revision;
   update();
 }
 
@@ -207,7 +144,9 @@ void DownloadedPiecesBar::updatePieceColors()
 
 void DownloadedPiecesBar::clear()
 {
-  image = QImage();
+  pieces = libtorrent::bitfield();
+  pieces_dl = libtorrent::bitfield();
+  ++revision;
   update();
 }
 
@@ -215,17 +154,10 @@ void DownloadedPiecesBar::paintEvent(QPaintEvent *)
 {
   QPainter painter(this);
   QRect imageRect(1, 1, width() - 2, height() - 2);
-  if (image.isNull())
-  {
-    painter.setBrush(Qt::white);
-    painter.drawRect(imageRect);
-  }
-  else
-  {
-    if (image.width() != imageRect.width())
-      updateImage();
-    painter.drawImage(imageRect, image);
-  }
+  // cached image is rebuilt only after changes or resize
+  if (image.width() != imageRect.width() || image_revision != revision)
+    updateImage();
+  painter.drawImage(imageRect, image);
   QPainterPath border;
   border.addRect(0, 0, width() - 1, height() - 1);
 
@@ -241,7 +173,7 @@ void DownloadedPiecesBar::setColors(int background, int border, int complete, in
   piece_color_dl = incomplete;
 
   updatePieceColors();
-  updateImage();
+  ++revision;
   update();
 }
 
@@ -60,16 +60,18 @@ private:
   std::vector<int> piece_colors;
 
   // last used bitfields, uses to better resize redraw
-  // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
   libtorrent::bitfield pieces;
   libtorrent::bitfield pieces_dl;
 
-  // scale bitfield vector to float vector
-  std::vector<float> bitfieldToFloatVector(const libtorrent::bitfield &vecin, int reqSize);
+  // changes counter of bitfields and colors, image is rebuilt when it moves
+  uint revision;
+  uint image_revision;
   // mix two colors by light model, ratio <0, 1>
   int mixTwoColors(int &rgb1, int &rgb2, float ratio);
   // draw new image and replace actual image
   void updateImage();
+  // bitfields have same bits
+  static bool equalBits(const libtorrent::bitfield &bf1, const libtorrent::bitfield &bf2);
 
 public:
   DownloadedPiecesBar(QWidget *parent);
@@ -0,0 +1,272 @@
+#include "peerlistmodel.h"
+#include "peerlistdelegate.h"
+#include "geoipmanager.h"
+#include "misc.h"
+#include "qtlibed2k/qed2ksession.h"
+
+#include <libtorrent/peer_info.hpp>
+
+using namespace libtorrent;
+
+uint qHash(const PeerKey& key)
+{
+  return qHash(QByteArray::fromRawData(reinterpret_cast<const char*>(key.address.data()), key.address.size()))
+      ^ (uint(key.port) << 16) ^ uint(key.transfer);
+}
+
+static PeerKey makeKey(int transfer, const libed2k::tcp::endpoint& ep)
+{
+  PeerKey key;
+  key.transfer = transfer;
+  key.port = ep.port();
+  if (ep.address().is_v4())
+    key.address = boost::asio::ip::address_v6::v4_mapped(ep.address().to_v4()).to_bytes();
+  else
+    key.address = ep.address().to_v6().to_bytes();
+  return key;
+}
+
+PeerListModel::PeerListModel(QObject *parent) :
+  QAbstractTableModel(parent), m_displayFlags(true)
+{
+  for (int i = 0; i < PeerListDelegate::COL_COUNT; ++i)
+    m_headers << QString();
+}
+
+int PeerListModel::rowCount(const QModelIndex &parent) const
+{
+  return parent.isValid() ? 0 : m_rows.size();
+}
+
+int PeerListModel::columnCount(const QModelIndex &parent) const
+{
+  Q_UNUSED(parent);
+  return PeerListDelegate::COL_COUNT;
+}
+
+QVariant PeerListModel::data(const QModelIndex &index, int role) const
+{
+  if (!index.isValid() || index.row() >= m_rows.size()) return QVariant();
+  const PeerRow &row = m_rows.at(index.row());
+
+  switch(role) {
+  case Qt::DisplayRole:
+    switch(index.column()) {
+    case PeerListDelegate::IP: return row.hostname.isEmpty() ? row.ip : row.hostname;
+    case PeerListDelegate::CONNECTION: return getConnectionString(row.info.connection_type);
+    case PeerListDelegate::CLIENT: return row.info.client;
+    case PeerListDelegate::FILE: return row.file;
+    case PeerListDelegate::PROGRESS: return row.info.progress;
+    case PeerListDelegate::DOWN_SPEED: return row.info.payload_down_speed;
+    case PeerListDelegate::UP_SPEED: return row.info.payload_up_speed;
+    case PeerListDelegate::TOT_DOWN: return (qulonglong)row.info.total_download;
+    case PeerListDelegate::TOT_UP: return (qulonglong)row.info.total_upload;
+    case PeerListDelegate::IP_HIDDEN: return row.address;
+    default: return QVariant();
+    }
+  case Qt::DecorationRole:
+    if (index.column() == PeerListDelegate::IP && m_displayFlags && !row.flag.isNull())
+      return row.flag;
+    break;
+  case Qt::ToolTipRole:
+    if (index.column() == PeerListDelegate::IP && m_displayFlags)
+      return row.country;
+    break;
+  default:
+    break;
+  }
+
+  return QVariant();
+}
+
+QVariant PeerListModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < m_headers.size())
+    return m_headers.at(section);
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool PeerListModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role)
+{
+  if (orientation != Qt::Horizontal || (role != Qt::EditRole && role != Qt::DisplayRole) ||
+      section < 0 || section >= m_headers.size())
+    return false;
+  m_headers[section] = value.toString();
+  emit headerDataChanged(orientation, section, section);
+  return true;
+}
+
+void PeerListModel::beginUpdate()
+{
+  for (int i = 0; i < m_rows.size(); ++i)
+    m_rows[i].seen = false;
+  m_added.clear();
+}
+
+void PeerListModel::updatePeer(const QString &hash, const QString &transfer_name, const PeerInfo &peer)
+{
+  const PeerKey key = makeKey(transferId(hash), peer.ip);
+  QHash<PeerKey, int>::const_iterator it = m_index.find(key);
+
+  if (it == m_index.end()) {
+    // New peer, strings are built only once
+    boost::system::error_code ec;
+    const QString ip = misc::toQString(peer.ip.address().to_string(ec));
+    if (ec) return;
+    PeerRow row;
+    row.key = key;
+    row.info = peer;
+    row.ip = ip;
+    row.address = ip + ":" + QString::number(peer.ip.port());
+    row.file = transfer_name;
+    row.seen = true;
+    setCountry(row);
+    m_index.insert(key, m_rows.size() + m_added.size());
+    m_added << row;
+    return;
+  }
+
+  const int r = it.value();
+  if (r >= m_rows.size()) return; // Duplicate in current snapshot
+  PeerRow &row = m_rows[r];
+  row.seen = true;
+
+  int first = PeerListDelegate::COL_COUNT;
+  int last = -1;
+#define PEER_COLUMN_CHANGED(col) { first = qMin(first, int(col)); last = qMax(last, int(col)); }
+  if (row.info.country[0] != peer.country[0] || row.info.country[1] != peer.country[1]) {
+    row.info.country[0] = peer.country[0];
+    row.info.country[1] = peer.country[1];
+    setCountry(row);
+    PEER_COLUMN_CHANGED(PeerListDelegate::IP);
+  }
+  if (row.info.connection_type != peer.connection_type) PEER_COLUMN_CHANGED(PeerListDelegate::CONNECTION);
+  if (row.info.client != peer.client) PEER_COLUMN_CHANGED(PeerListDelegate::CLIENT);
+  if (row.info.progress != peer.progress) PEER_COLUMN_CHANGED(PeerListDelegate::PROGRESS);
+  if (row.info.payload_down_speed != peer.payload_down_speed) PEER_COLUMN_CHANGED(PeerListDelegate::DOWN_SPEED);
+  if (row.info.payload_up_speed != peer.payload_up_speed) PEER_COLUMN_CHANGED(PeerListDelegate::UP_SPEED);
+  if (row.info.total_download != peer.total_download) PEER_COLUMN_CHANGED(PeerListDelegate::TOT_DOWN);
+  if (row.info.total_upload != peer.total_upload) PEER_COLUMN_CHANGED(PeerListDelegate::TOT_UP);
+#undef PEER_COLUMN_CHANGED
+
+  if (last >= 0) {
+    row.info = peer;
+    emit dataChanged(index(r, first), index(r, last));
+  }
+}
+
+void PeerListModel::endUpdate()
+{
+  // Remove gone peers by contiguous ranges, from the end so rows before stay valid
+  int lowest = m_rows.size();
+  int r = m_rows.size() - 1;
+  while (r >= 0) {
+    if (m_rows.at(r).seen) {
+      --r;
+      continue;
+    }
+    const int last = r;
+    while (r >= 0 && !m_rows.at(r).seen)
+      m_index.remove(m_rows.at(r--).key);
+    const int first = r + 1;
+    beginRemoveRows(QModelIndex(), first, last);
+    m_rows.remove(first, last - first + 1);
+    endRemoveRows();
+    lowest = first;
+  }
+
+  // Rows after removed ranges were shifted, pending rows too
+  for (int i = lowest; i < m_rows.size(); ++i)
+    m_index[m_rows.at(i).key] = i;
+
+  if (!m_added.isEmpty()) {
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size() + m_added.size() - 1);
+    for (int i = 0; i < m_added.size(); ++i) {
+      m_index[m_added.at(i).key] = m_rows.size();
+      m_rows << m_added.at(i);
+    }
+    endInsertRows();
+    m_added.clear();
+  }
+}
+
+void PeerListModel::clear()
+{
+  if (m_rows.isEmpty()) return;
+  beginResetModel();
+  m_rows.clear();
+  m_added.clear();
+  m_index.clear();
+  m_transferIds.clear();
+  m_transferHashes.clear();
+  endResetModel();
+}
+
+void PeerListModel::setDisplayFlags(bool display)
+{
+  if (m_displayFlags == display) return;
+  m_displayFlags = display;
+  if (!m_rows.isEmpty())
+    emit dataChanged(index(0, PeerListDelegate::IP), index(m_rows.size() - 1, PeerListDelegate::IP));
+}
+
+void PeerListModel::setHostName(const QString &ip, const QString &hostname)
+{
+  for (int r = 0; r < m_rows.size(); ++r) {
+    if (m_rows.at(r).ip == ip) {
+      m_rows[r].hostname = hostname;
+      emit dataChanged(index(r, PeerListDelegate::IP), index(r, PeerListDelegate::IP));
+    }
+  }
+}
+
+QString PeerListModel::transferHash(int row) const
+{
+  if (row < 0 || row >= m_rows.size()) return QString();
+  return m_transferHashes.value(m_rows.at(row).key.transfer);
+}
+
+libed2k::tcp::endpoint PeerListModel::endpoint(int row) const
+{
+  if (row < 0 || row >= m_rows.size()) return libed2k::tcp::endpoint();
+  return m_rows.at(row).info.ip;
+}
+
+int PeerListModel::transferId(const QString &hash)
+{
+  QHash<QString, int>::const_iterator it = m_transferIds.find(hash);
+  if (it != m_transferIds.end()) return it.value();
+  const int id = m_transferHashes.size();
+  m_transferHashes << hash;
+  m_transferIds.insert(hash, id);
+  return id;
+}
+
+void PeerListModel::setCountry(PeerRow &row)
+{
+  row.flag = GeoIPManager::CountryISOCodeToIcon(row.info.country);
+  row.country = row.flag.isNull() ? QString() : GeoIPManager::CountryISOCodeToName(row.info.country);
+}
+
+QString PeerListModel::getConnectionString(int connection_type)
+{
+  QString connection;
+  switch(connection_type) {
+  case libed2k::STANDARD_EDONKEY:
+    connection = "eDonkey";
+    break;
+#if LIBTORRENT_VERSION_MINOR > 15
+  case peer_info::bittorrent_utp:
+    connection = "uTP";
+    break;
+  case peer_info::http_seed:
+#endif
+  case peer_info::web_seed:
+    connection = "Web";
+    break;
+  default:
+    connection = "BT";
+    break;
+  }
+  return connection;
+}
@@ -0,0 +1,77 @@
+#ifndef PEERLISTMODEL_H
+#define PEERLISTMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QHash>
+#include <QIcon>
+#include <QStringList>
+#include "transport/transfer_base.h"
+
+#include <boost/asio/ip/address_v6.hpp>
+
+// Binary peer identity: transfer id and endpoint, IPv4 stored as mapped IPv6
+struct PeerKey {
+  int transfer;
+  unsigned short port;
+  boost::asio::ip::address_v6::bytes_type address;
+
+  bool operator==(const PeerKey& k) const {
+    return transfer == k.transfer && port == k.port && address == k.address;
+  }
+};
+
+uint qHash(const PeerKey& key);
+
+// Peers table, rows are changed by diff of consecutive peer snapshots:
+// beginUpdate(), updatePeer() for each current peer, endUpdate()
+class PeerListModel : public QAbstractTableModel {
+  Q_OBJECT
+
+public:
+  explicit PeerListModel(QObject *parent = 0);
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const;
+  int columnCount(const QModelIndex &parent = QModelIndex()) const;
+  QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+  QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+  bool setHeaderData(int section, Qt::Orientation orientation, const QVariant &value, int role = Qt::EditRole);
+
+  void beginUpdate();
+  void updatePeer(const QString &hash, const QString &transfer_name, const PeerInfo &peer);
+  void endUpdate();
+  void clear();
+
+  void setDisplayFlags(bool display);
+  void setHostName(const QString &ip, const QString &hostname);
+  QString transferHash(int row) const;
+  libed2k::tcp::endpoint endpoint(int row) const;
+
+  static QString getConnectionString(int connection_type);
+
+private:
+  struct PeerRow {
+    PeerKey key;
+    PeerInfo info;
+    QString ip;
+    QString address; // ip:port
+    QString file;
+    QString hostname;
+    QString country;
+    QIcon flag;
+    bool seen; // found in current snapshot
+  };
+
+  int transferId(const QString &hash);
+  void setCountry(PeerRow &row);
+
+  QVector<PeerRow> m_rows;
+  QVector<PeerRow> m_added;
+  QHash<PeerKey, int> m_index; // key -> row
+  QHash<QString, int> m_transferIds;
+  QStringList m_transferHashes; // id -> hash
+  QStringList m_headers;
+  bool m_displayFlags;
+};
+
+#endif // PEERLISTMODEL_H
@@ -30,6 +30,7 @@
 
 #include "peerlistwidget.h"
 #include "peerlistdelegate.h"
+#include "peerlistmodel.h"
 #include "reverseresolution.h"
 #include "preferences.h"
 #include "geoipmanager.h"
@@ -43,7 +44,6 @@
 #include <libtorrent/peer_info.hpp>
 
 #include <QMessageBox>
-#include <QStandardItemModel>
 #include <QSortFilterProxyModel>
 #include <QSet>
 #include <QHeaderView>
@@ -65,7 +65,7 @@ PeerListWidget::PeerListWidget(QWidget *parent):
     setAllColumnsShowFocus(true);
     setSelectionMode(QAbstractItemView::SingleSelection);
     // List Model
-    m_listModel = new QStandardItemModel(0, PeerListDelegate::COL_COUNT);
+    m_listModel = new PeerListModel();
     m_listModel->setHeaderData(PeerListDelegate::IP, Qt::Horizontal, tr("IP"));
     m_listModel->setHeaderData(PeerListDelegate::CONNECTION, Qt::Horizontal, tr("Connection"));
     m_listModel->setHeaderData(PeerListDelegate::CLIENT, Qt::Horizontal, tr("Client", "i.e.: Client application"));
@@ -143,6 +143,7 @@ void PeerListWidget::updatePeerCountryResolutionState()
 {
   if (Preferences().resolvePeerCountries() != m_displayFlags) {
     m_displayFlags = !m_displayFlags;
+    m_listModel->setDisplayFlags(m_displayFlags);
     if (m_displayFlags)
       loadPeers();
   }
@@ -155,23 +156,14 @@ void PeerListWidget::showPeerListMenu(const QPoint&)
         return;
 
     int row = m_proxyModel->mapToSource(selectedIndexes[0]).row();
-    QHash<QString, QStandardItem*>::iterator iter;
-    for (iter = m_peerItems.begin(); iter != m_peerItems.end(); ++iter)
-    {
-        if (iter.value()->row() == row)
-        {
-            break;
-        }
-    }
-    QString hash = iter.key();
-    hash = hash.left(hash.indexOf(":"));
+    QString hash = m_listModel->transferHash(row);
     if (!hash.length())
         return;
     Transfer t = Session::instance()->getTransfer(hash);
     if (t.type() == Transfer::ED2K)
     {
         peerBrowseFiles->setEnabled(false);
-        if (QED2KPeerHandle::getPeerHandle(getPeerNetPoint(iter.value())).isAllowedSharedFilesView())
+        if (QED2KPeerHandle::getPeerHandle(getPeerNetPoint(row)).isAllowedSharedFilesView())
             peerBrowseFiles->setEnabled(true);
 
         peerMenu->exec(QCursor::pos());
@@ -337,14 +329,7 @@ void PeerListWidget::limitDlRateSelectedPeers(const QStringList& peer_ips)
 
 void PeerListWidget::clear() {
   qDebug("clearing peer list");
-  m_peerItems.clear();
-  m_peerEndpoints.clear();
-  m_missingFlags.clear();
-  int nbrows = m_listModel->rowCount();
-  if (nbrows > 0) {
-    qDebug("Cleared %d peers", nbrows);
-    m_listModel->removeRows(0,  nbrows);
-  }
+  m_listModel->clear();
 }
 
 void PeerListWidget::loadSettings()
@@ -359,9 +344,23 @@ void PeerListWidget::saveSettings() const
 
 void PeerListWidget::loadPeers(bool force_hostname_resolution) 
 {
-    std::vector<Transfer> transfers = Session::instance()->getActiveTransfers();
+    // Peers are loaded again when the list is shown
+    if (!isVisible())
+        return;
+
+    std::vector<Transfer> transfers;
+    if (m_selectedTransfers.isEmpty())
+    {
+        transfers = Session::instance()->getActiveTransfers();
+    }
+    else
+    {
+        foreach(const QString& hash, m_selectedTransfers)
+            transfers.push_back(Session::instance()->getTransfer(hash));
+    }
+
     std::vector<Transfer>::iterator transferIt;
-    QSet<QString> old_peers_set = m_peerItems.keys().toSet();
+    m_listModel->beginUpdate();
     for(transferIt = transfers.begin(); transferIt != transfers.end(); transferIt++)
     {
         Transfer h = *transferIt;
@@ -371,49 +370,36 @@ void PeerListWidget::loadPeers(bool force_hostname_resolution)
         QString torrent_name = TorrentPersistentData::getName(h.hash());
         if(torrent_name.isEmpty()) torrent_name = h.name();
 
-        boost::system::error_code ec;
         std::vector<PeerInfo> peers;
         h.get_peer_info(peers);
         std::vector<PeerInfo>::iterator itr;
 
         for(itr = peers.begin(); itr != peers.end(); itr++) 
         {
-            PeerInfo peer = *itr;
-
-            if (m_showDownload && peer.payload_down_speed == 0)
+            if (m_showDownload && itr->payload_down_speed == 0)
                 continue;
-            if (!m_showDownload && peer.payload_up_speed == 0)
+            if (!m_showDownload && itr->payload_up_speed == 0)
                 continue;
 
-            QString peer_ip = misc::toQString(peer.ip.address().to_string(ec));
-            QString peer_key = h.hash() + ":" + peer_ip;
-            QString address = peer_ip + ":" + QString::number(peer.ip.port());
-            if(ec) 
-                continue;
-            if(m_peerItems.contains(peer_key)) 
-            {
-                // Update existing peer
-                updatePeer(peer_key, peer);
-                old_peers_set.remove(peer_key);
-            } 
-            else 
-            {
-                // Add new peer
-                m_peerItems[peer_key] = addPeer(peer_ip, address, peer, torrent_name);
-                m_peerEndpoints[peer_key] = peer.ip;
-            }
+            m_listModel->updatePeer(h.hash(), torrent_name, *itr);
         }        
     }
-    // Delete peers that are gone
-    QSetIterator<QString> it(old_peers_set);
-    while(it.hasNext()) 
-    {
-        const QString& ip = it.next();
-        m_missingFlags.remove(ip);
-        m_peerEndpoints.remove(ip);
-        QStandardItem *item = m_peerItems.take(ip);
-        m_listModel->removeRow(item->row());
-    }
+    // Gone peers are removed, new peers are appended
+    m_listModel->endUpdate();
+}
+
+void PeerListWidget::setSelectedTransfers(const QStringList& hashes)
+{
+    if (m_selectedTransfers == hashes)
+        return;
+    m_selectedTransfers = hashes;
+    loadPeers();
+}
+
+void PeerListWidget::showEvent(QShowEvent *event)
+{
+    QTreeView::showEvent(event);
+    loadPeers();
 }
 
 void PeerListWidget::showDownload(bool download)
@@ -431,64 +417,9 @@ void PeerListWidget::showDownload(bool download)
     loadPeers();
 }
 
-QStandardItem* PeerListWidget::addPeer(
-    const QString& ip, const QString& address, const PeerInfo& peer, QString torrent_name)
-{
-  int row = m_listModel->rowCount();
-  // Adding Peer to peer list
-  m_listModel->insertRow(row);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), ip);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP_HIDDEN), address);
-
-  if (m_displayFlags) {
-    const QIcon ico = GeoIPManager::CountryISOCodeToIcon(peer.country);
-    if (!ico.isNull()) {
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), ico, Qt::DecorationRole);
-      const QString country_name = GeoIPManager::CountryISOCodeToName(peer.country);
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), country_name, Qt::ToolTipRole);
-    } else {
-      m_missingFlags.insert(ip);
-    }
-  }
-
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CONNECTION), getConnectionString(peer.connection_type));
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CLIENT), peer.client);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::FILE), torrent_name);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::PROGRESS), peer.progress);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::DOWN_SPEED), peer.payload_down_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::UP_SPEED), peer.payload_up_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_DOWN), (qulonglong)peer.total_download);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_UP), (qulonglong)peer.total_upload);
-  return m_listModel->item(row, PeerListDelegate::IP);
-}
-
-void PeerListWidget::updatePeer(const QString& ip, const PeerInfo& peer) {
-  QStandardItem *item = m_peerItems.value(ip);
-  int row = item->row();
-  if (m_displayFlags) {
-    const QIcon ico = GeoIPManager::CountryISOCodeToIcon(peer.country);
-    if (!ico.isNull()) {
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), ico, Qt::DecorationRole);
-      const QString country_name = GeoIPManager::CountryISOCodeToName(peer.country);
-      m_listModel->setData(m_listModel->index(row, PeerListDelegate::IP), country_name, Qt::ToolTipRole);
-      m_missingFlags.remove(ip);
-    }
-  }
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CONNECTION), getConnectionString(peer.connection_type));
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::CLIENT), peer.client);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::PROGRESS), peer.progress);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::DOWN_SPEED), peer.payload_down_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::UP_SPEED), peer.payload_up_speed);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_DOWN), (qulonglong)peer.total_download);
-  m_listModel->setData(m_listModel->index(row, PeerListDelegate::TOT_UP), (qulonglong)peer.total_upload);
-}
-
 void PeerListWidget::handleResolved(const QString &ip, const QString &hostname) {
-  QStandardItem *item = m_peerItems.value(ip, 0);
-  if (item) {
-    qDebug("Resolved %s -> %s", qPrintable(ip), qPrintable(hostname));
-    item->setData(hostname, Qt::DisplayRole);
-  }
+  qDebug("Resolved %s -> %s", qPrintable(ip), qPrintable(hostname));
+  m_listModel->setHostName(ip, hostname);
 }
 
 void PeerListWidget::handleSortColumnChanged(int col)
@@ -501,107 +432,66 @@ void PeerListWidget::handleSortColumnChanged(int col)
   }
 }
 
-QString PeerListWidget::getConnectionString(int connection_type)
-{
-  QString connection;
-  switch(connection_type) {
-  case libed2k::STANDARD_EDONKEY:
-    connection = "eDonkey";
-    break;
-#if LIBTORRENT_VERSION_MINOR > 15
-  case peer_info::bittorrent_utp:
-    connection = "uTP";
-    break;
-  case peer_info::http_seed:
-#endif
-  case peer_info::web_seed:
-    connection = "Web";
-    break;
-  default:
-    connection = "BT";
-    break;
-  }
-  return connection;
-}
-
 void PeerListWidget::addToFriends()
 {
-    QStandardItem* item = getSelectedItem();
-    if (!item)
+    int row = getSelectedRow();
+    if (row < 0)
         return;
 
-    libed2k::net_identifier np = getPeerNetPoint(item);
+    libed2k::net_identifier np = getPeerNetPoint(row);
     emit addFriend(QED2KPeerHandle::getPeerHandle(np).getUserName(), np);
 }
 
 void PeerListWidget::sendMessage()
 {
-    QStandardItem* item = getSelectedItem();
-    if (!item)
+    int row = getSelectedRow();
+    if (row < 0)
         return;
 
-    libed2k::net_identifier np = getPeerNetPoint(item);
+    libed2k::net_identifier np = getPeerNetPoint(row);
     emit sendMessage(QED2KPeerHandle::getPeerHandle(np).getUserName(), np);
 }
 
 void PeerListWidget::requestUserDirs()
 {
-    QStandardItem* item = getSelectedItem();
-    if (!item)
+    int row = getSelectedRow();
+    if (row < 0)
         return;
 
-    QED2KPeerHandle::getPeerHandle(getPeerNetPoint(item)).requestDirs();
+    QED2KPeerHandle::getPeerHandle(getPeerNetPoint(row)).requestDirs();
 }
 
 void PeerListWidget::getPeerDetails()
 {
-    QStandardItem* item = getSelectedItem();
-    if (!item)
+    int row = getSelectedRow();
+    if (row < 0)
         return;
 
-    libed2k::net_identifier np = getPeerNetPoint(item);
+    libed2k::net_identifier np = getPeerNetPoint(row);
 
     user_properties dlg(this, QED2KPeerHandle::getPeerHandle(np).getUserName(), np);
     dlg.exec();
 }
 
-QStandardItem* PeerListWidget::getSelectedItem()
+int PeerListWidget::getSelectedRow() const
 {
     QModelIndexList selectedIndexes = selectionModel()->selectedIndexes();
     if (selectedIndexes.empty())
-        return NULL;
-
-    int row = m_proxyModel->mapToSource(selectedIndexes[0]).row();
-    QHash<QString, QStandardItem*>::iterator iter;
-    for (iter = m_peerItems.begin(); iter != m_peerItems.end(); ++iter)
-    {
-        if (iter.value()->row() == row)
-        {
-            return iter.value();
-        }
-    }    
+        return -1;
 
-    return NULL;
+    return m_proxyModel->mapToSource(selectedIndexes[0]).row();
 }
 
-libed2k::net_identifier PeerListWidget::getPeerNetPoint(QStandardItem* item)
+libed2k::net_identifier PeerListWidget::getPeerNetPoint(int row) const
 {
     libed2k::net_identifier np;
 
-    if (!item)
-        return np;
-
-    QString ip = m_listModel->data(m_listModel->index(item->row(), PeerListDelegate::IP_HIDDEN)).toString();
-    if (!ip.length() || ip.indexOf(":") < 0)
-        return np;
-
-    QString port = ip.right(ip.length() - ip.indexOf(":") - 1);
-    ip = ip.left(ip.indexOf(":"));
-    if (!ip.length() || !port.length())
+    if (row < 0)
         return np;
 
-    np.m_nIP = libed2k::address2int(address::from_string(ip.toStdString()));
-    np.m_nPort = port.toInt();
+    libed2k::tcp::endpoint ep = m_listModel->endpoint(row);
+    np.m_nIP = libed2k::address2int(ep.address());
+    np.m_nPort = ep.port();
 
     return np;
 }
@@ -41,11 +41,10 @@
 #include "qtlibed2k/qed2ksession.h"
 
 class PeerListDelegate;
+class PeerListModel;
 
 QT_BEGIN_NAMESPACE
 class QSortFilterProxyModel;
-class QStandardItem;
-class QStandardItemModel;
 QT_END_NAMESPACE
 
 #include <boost/version.hpp>
@@ -64,9 +63,8 @@ public:
 
 public slots:
   void loadPeers(bool force_hostname_resolution = false);
-  QStandardItem* addPeer(
-      const QString& ip, const QString& address, const PeerInfo& peer, QString torrent_name);
-  void updatePeer(const QString& ip, const PeerInfo& peer);
+  // Load peers of these transfers only, all active transfers when empty
+  void setSelectedTransfers(const QStringList& hashes);
   void handleResolved(const QString &ip, const QString &hostname);
   void updatePeerCountryResolutionState();
   void clear();
@@ -85,18 +83,18 @@ protected slots:
   void requestUserDirs();
   void getPeerDetails();
 
+protected:
+  void showEvent(QShowEvent *event);
+
 private:
-  static QString getConnectionString(int connection_type);
-  QStandardItem* getSelectedItem();
-  libed2k::net_identifier getPeerNetPoint(QStandardItem* item);
+  int getSelectedRow() const;
+  libed2k::net_identifier getPeerNetPoint(int row) const;
 
 private:
-  QStandardItemModel *m_listModel;
+  PeerListModel *m_listModel;
   PeerListDelegate *m_listDelegate;
   QSortFilterProxyModel *m_proxyModel;
-  QHash<QString, QStandardItem*> m_peerItems;
-  QHash<QString, boost::asio::ip::tcp::endpoint> m_peerEndpoints;
-  QSet<QString> m_missingFlags;
+  QStringList m_selectedTransfers;
   bool m_displayFlags;
   bool m_showDownload;
   QMenu* peerMenu;
@@ -29,11 +29,12 @@
  */
 
 #include "pieceavailabilitybar.h"
+#include "piecesscale.h"
 
 //#include <QDebug>
 
 PieceAvailabilityBar::PieceAvailabilityBar(QWidget *parent) :
-  QWidget(parent)
+  QWidget(parent), revision(0), image_revision(0)
 {
   setFixedHeight(BAR_HEIGHT);
 
@@ -44,101 +45,6 @@ PieceAvailabilityBar::PieceAvailabilityBar(QWidget *parent) :
   updatePieceColors();
 }
 
-std::vector<float> PieceAvailabilityBar::intToFloatVector(const std::vector<int> &vecin, int reqSize)
-{
-  std::vector<float> result(reqSize, 0.0);
-
-  if (vecin.empty())
-    return result;
-
-  const float ratio = vecin.size() / (float)reqSize;
-
-  const int maxElement = *std::max_element(vecin.begin(), vecin.end());
-
-  // qMax bacause in normalization we don't want divide by 0
-  // if maxElement == 0 check will be disabled please enable this line:
-  // const int maxElement = qMax(*std::max_element(avail.begin(), avail.end()), 1);
-
-  if (maxElement == 0)
-    return result;
-
-  // simple linear transformation algorithm
-  // for example:
-  // image.x(0) = pieces.x(0.0 >= x < 1.7)
-  // image.x(1) = pieces.x(1.7 >= x < 3.4)
-
-  for (int x = 0; x < reqSize; ++x) {
-
-    // don't use previously calculated value "ratio" here!!!
-    // float cannot save irrational number like 7/9, if this number will be rounded up by std::ceil
-    // give you x2 == pieces.size(), and index out of range: pieces[x2]
-    // this code is safe, so keep that in mind when you try optimize more.
-    // tested with size = 3000000ul
-
-    // R - real
-    const float fromR = (x * vecin.size()) / (float)reqSize;
-    const float toR = ((x + 1) * vecin.size()) / (float)reqSize;
-
-    // C - integer
-    int fromC = fromR;// std::floor not needed
-    int toC = std::ceil(toR);
-
-    // position in pieces table
-    // libtorrent::bitfield::m_size is unsigned int(31 bits), so qlonglong is not needed
-    // tested with size = 3000000ul
-    int x2 = fromC;
-
-    // little speed up for really big pieces table, 10K+ size
-    const int toCMinusOne = toC - 1;
-
-    // value in returned vector
-    float value = 0;
-
-    // case when calculated range is (15.2 >= x < 15.7)
-    if (x2 == toCMinusOne) {
-      if (vecin[x2]) {
-        value += (toR - fromR) * vecin[x2];
-      }
-      ++x2;
-    }
-    // case when (15.2 >= x < 17.8)
-    else {
-      // subcase (15.2 >= x < 16)
-      if (x2 != fromR) {
-        if (vecin[x2]) {
-          value += (1.0 - (fromR - fromC)) * vecin[x2];
-        }
-        ++x2;
-      }
-
-      // subcase (16 >= x < 17)
-      for (; x2 < toCMinusOne; ++x2) {
-        if (vecin[x2]) {
-          value += vecin[x2];
-        }
-      }
-
-      // subcase (17 >= x < 17.8)
-      if (x2 == toCMinusOne) {
-        if (vecin[x2]) {
-          value += (1.0 - (toC - toR)) * vecin[x2];
-        }
-        ++x2;
-      }
-    }
-
-    // normalization <0, 1>
-    value /= ratio * maxElement;
-
-    // float precision sometimes gives > 1, because in not possible to store irrational numbers
-    value = qMin(value, (float)1.0);
-
-    result[x] = value;
-  }
-
-  return result;
-}
-
 int PieceAvailabilityBar::mixTwoColors(int &rgb1, int &rgb2, float ratio)
 {
   int r1 = qRed(rgb1);
@@ -162,14 +68,15 @@ void PieceAvailabilityBar::updateImage()
   //  qDebug() << "updateImageAv";
   QImage image2(width() - 2, 1, QImage::Format_RGB888);
 
+  image_revision = revision;
+
   if (pieces.empty()) {
     image2.fill(0xffffff);
     image = image2;
-    update();
     return;
   }
 
-  std::vector<float> scaled_pieces = intToFloatVector(pieces, image2.width());
+  std::vector<float> scaled_pieces = scaleAvailability(pieces, image2.width());
 
   // filling image
   for (unsigned int x = 0; x < scaled_pieces.size(); ++x)
@@ -182,9 +89,13 @@ void PieceAvailabilityBar::updateImage()
 
 void PieceAvailabilityBar::setAvailability(const std::vector<int>& avail)
 {
-  pieces = std::vector<int>(avail);
+  if (avail == pieces)
+    return;
+
+  pieces = avail;
 
-  updateImage();
+  // image is rebuilt on paint
+  ++revision;
   update();
 }
 
@@ -199,7 +110,8 @@ void PieceAvailabilityBar::updatePieceColors()
 
 void PieceAvailabilityBar::clear()
 {
-  image = QImage();
+  pieces.clear();
+  ++revision;
   update();
 }
 
@@ -207,17 +119,10 @@ void PieceAvailabilityBar::paintEvent(QPaintEvent *)
 {
   QPainter painter(this);
   QRect imageRect(1, 1, width() - 2, height() - 2);
-  if (image.isNull())
-  {
-    painter.setBrush(Qt::white);
-    painter.drawRect(imageRect);
-  }
-  else
-  {
-    if (image.width() != imageRect.width())
-      updateImage();
-    painter.drawImage(imageRect, image);
-  }
+  // cached image is rebuilt only after changes or resize
+  if (image.width() != imageRect.width() || image_revision != revision)
+    updateImage();
+  painter.drawImage(imageRect, image);
   QPainterPath border;
   border.addRect(0, 0, width() - 1, height() - 1);
 
@@ -232,7 +137,7 @@ void PieceAvailabilityBar::setColors(int background, int border, int available)
   piece_color = available;
 
   updatePieceColors();
-  updateImage();
+  ++revision;
   update();
 }
 
@@ -58,11 +58,11 @@ private:
   std::vector<int> piece_colors;
 
   // last used int vector, uses to better resize redraw
-  // TODO: make a diff pieces to new pieces and update only changed pixels, speedup when update > 20x faster
   std::vector<int> pieces;
 
-  // scale int vector to float vector
-  std::vector<float> intToFloatVector(const std::vector<int> &vecin, int reqSize);
+  // changes counter of availability and colors, image is rebuilt when it moves
+  uint revision;
+  uint image_revision;
 
   // mix two colors by light model, ratio <0, 1>
   int mixTwoColors(int &rgb1, int &rgb2, float ratio);
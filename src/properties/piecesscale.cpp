@@ -0,0 +1,130 @@
+#include "piecesscale.h"
+
+#include <QtGlobal>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+inline int popcount32(quint32 v)
+{
+#if defined(__GNUC__)
+  return __builtin_popcount(v);
+#else
+  v = v - ((v >> 1) & 0x55555555);
+  v = (v & 0x33333333) + ((v >> 2) & 0x33333333);
+  return (((v + (v >> 4)) & 0x0F0F0F0F) * 0x01010101) >> 24;
+#endif
+}
+
+// libtorrent bitfield keeps first piece in highest bit of first byte
+inline int bitAt(const unsigned char *data, qint64 pos)
+{
+  return (data[pos >> 3] >> (7 - (pos & 7))) & 1;
+}
+
+// number of set bits in [from, to)
+qint64 countBits(const unsigned char *data, qint64 from, qint64 to)
+{
+  qint64 count = 0;
+
+  for (; from < to && (from & 7); ++from)
+    count += bitAt(data, from);
+
+  // bit order in byte doesn't matter for counting, whole words at once
+  const unsigned char *p = data + (from >> 3);
+  for (; to - from >= 32; from += 32, p += 4) {
+    quint32 word;
+    memcpy(&word, p, sizeof(word));
+    count += popcount32(word);
+  }
+
+  for (; to - from >= 8; from += 8, ++p)
+    count += popcount32(*p);
+
+  for (; from < to; ++from)
+    count += bitAt(data, from);
+
+  return count;
+}
+
+}
+
+std::vector<float> scaleBitfield(const libtorrent::bitfield &vecin, int reqSize)
+{
+  std::vector<float> result(qMax(reqSize, 0), 0.0);
+  const qint64 size = vecin.size();
+
+  if (size == 0 || reqSize <= 0)
+    return result;
+
+  const unsigned char *data = reinterpret_cast<const unsigned char*>(vecin.bytes());
+  const double ratio = size / (double)reqSize;
+
+  // integer bounds, x * size / reqSize never steps out of pieces range
+  qint64 base = 0;        // whole pieces before bound
+  qint64 baseCount = 0;   // set bits in [0, base)
+  double prev = 0;        // coverage up to previous bound
+
+  for (int x = 0; x < reqSize; ++x) {
+    const qint64 num = (x + 1) * size;
+    const qint64 pos = num / reqSize;
+    const double frac = (num % reqSize) / (double)reqSize;
+
+    baseCount += countBits(data, base, pos);
+    base = pos;
+
+    double cur = baseCount;
+    if (frac > 0 && pos < size && bitAt(data, pos))
+      cur += frac;
+
+    result[x] = qMin((cur - prev) / ratio, 1.0);
+    prev = cur;
+  }
+
+  return result;
+}
+
+std::vector<float> scaleAvailability(const std::vector<int> &vecin, int reqSize)
+{
+  std::vector<float> result(qMax(reqSize, 0), 0.0);
+  const qint64 size = vecin.size();
+
+  if (size == 0 || reqSize <= 0)
+    return result;
+
+  const int maxElement = *std::max_element(vecin.begin(), vecin.end());
+
+  // in normalization we don't want divide by 0
+  if (maxElement == 0)
+    return result;
+
+  const double norm = size / (double)reqSize * maxElement;
+  const int *data = &vecin[0];
+
+  qint64 base = 0;
+  qint64 baseSum = 0;     // sum of [0, base)
+  double prev = 0;
+
+  for (int x = 0; x < reqSize; ++x) {
+    const qint64 num = (x + 1) * size;
+    const qint64 pos = num / reqSize;
+    const double frac = (num % reqSize) / (double)reqSize;
+
+    // plain loop, compiler vectorizes it
+    qint64 sum = 0;
+    for (qint64 i = base; i < pos; ++i)
+      sum += data[i];
+    baseSum += sum;
+    base = pos;
+
+    double cur = baseSum;
+    if (frac > 0 && pos < size)
+      cur += frac * data[pos];
+
+    result[x] = qMin((cur - prev) / norm, 1.0);
+    prev = cur;
+  }
+
+  return result;
+}
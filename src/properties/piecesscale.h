@@ -0,0 +1,18 @@
+#ifndef PIECESSCALE_H
+#define PIECESSCALE_H
+
+#include <vector>
+#include <libtorrent/bitfield.hpp>
+
+// Pieces bars resampling, every output pixel x covers pieces range
+// [x * size / reqSize, (x + 1) * size / reqSize), partially covered pieces
+// are counted by their covered part. Values are normalized to <0, 1>
+
+// share of set bits per pixel, bits are counted word by word with popcount
+std::vector<float> scaleBitfield(const libtorrent::bitfield &vecin, int reqSize);
+
+// average availability per pixel divided by maximal availability,
+// computed as difference of running prefix sums at pixel bounds
+std::vector<float> scaleAvailability(const std::vector<int> &vecin, int reqSize);
+
+#endif // PIECESSCALE_H
@@ -1,13 +1,17 @@
 INCLUDEPATH += $$PWD
 
 HEADERS += $$PWD/peerlistwidget.h \
+           $$PWD/peerlistmodel.h \
            $$PWD/proplistdelegate.h \
            $$PWD/downloadedpiecesbar.h \
            $$PWD/peerlistdelegate.h \
            $$PWD/pieceavailabilitybar.h \
+           $$PWD/piecesscale.h \
            $$PWD/proptabbar.h
 
 SOURCES += $$PWD/peerlistwidget.cpp \
+           $$PWD/peerlistmodel.cpp \
            $$PWD/proptabbar.cpp \
            $$PWD/downloadedpiecesbar.cpp \
-           $$PWD/pieceavailabilitybar.cpp
+           $$PWD/pieceavailabilitybar.cpp \
+           $$PWD/piecesscale.cpp
@@ -81,7 +81,7 @@ PropertiesWidget::PropertiesWidget(QWidget *parent, MainWindow* main_window, Tra
   filesList->setSortingEnabled(true);
   // Torrent content filtering
   m_contentFilerLine = new LineEdit(this);
-  connect(m_contentFilerLine, SIGNAL(textChanged(QString)), PropListModel, SLOT(setFilterFixedString(QString)));
+  connect(m_contentFilerLine, SIGNAL(textChanged(QString)), PropListModel, SLOT(setNameFilter(QString)));
   contentFilterLayout->insertWidget(1, m_contentFilerLine);
 
   // SIGNAL/SLOTS
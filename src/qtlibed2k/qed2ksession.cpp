@@ -34,7 +34,8 @@ static libed2k::md4_hash QStringToMD4(const QString& s)
 
 QString md4toQString(const libed2k::md4_hash& hash)
 {
-    return QString::fromAscii(hash.toString().c_str(), hash.toString().size());
+    std::string str = hash.toString();
+    return QString::fromAscii(str.c_str(), str.size());
 }
 
 QED2KSearchResultEntry::QED2KSearchResultEntry() :
@@ -83,10 +84,8 @@ void QED2KSearchResultEntry::save(Preferences& pref) const
 }
 
 // static
-QED2KSearchResultEntry QED2KSearchResultEntry::fromSharedFileEntry(const libed2k::shared_file_entry& sf)
+bool QED2KSearchResultEntry::fromSharedFileEntry(const libed2k::shared_file_entry& sf, QED2KSearchResultEntry& sre)
 {
-    QED2KSearchResultEntry sre;
-
     sre.m_hFile = md4toQString(sf.m_hFile);
     sre.m_network_point = sf.m_network_point;
 
@@ -160,7 +159,7 @@ QED2KSearchResultEntry QED2KSearchResultEntry::fromSharedFileEntry(const libed2k
         qDebug("%s", e.what());
     }
 
-    return (sre);
+    return sre.isCorrect();
 }
 
 bool QED2KSearchResultEntry::isCorrect() const
@@ -658,18 +657,19 @@ void QED2KSession::readAlerts()
         }
         else if (libed2k::shared_files_alert* p = dynamic_cast<libed2k::shared_files_alert*>(a.get()))
         {
-            std::vector<QED2KSearchResultEntry> vRes;
-            vRes.resize(p->m_files.m_collection.size());
             bool bMoreResult = p->m_more;
 
+            // tags are decoded in place into one vector, all receivers share it
+            std::vector<QED2KSearchResultEntry>* entries = new std::vector<QED2KSearchResultEntry>();
+            QED2KSearchResultBatch vRes(entries);
+            entries->reserve(p->m_files.m_collection.size());
+
             for (size_t n = 0; n < p->m_files.m_collection.size(); ++n)
             {
-                QED2KSearchResultEntry sre = QED2KSearchResultEntry::fromSharedFileEntry(p->m_files.m_collection[n]);
+                entries->push_back(QED2KSearchResultEntry());
 
-                if (sre.isCorrect())
-                {
-                    vRes[n] = sre;
-                }
+                if (!QED2KSearchResultEntry::fromSharedFileEntry(p->m_files.m_collection[n], entries->back()))
+                    entries->pop_back();
             }
 
             // emit special signal for derived class
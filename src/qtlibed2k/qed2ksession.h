@@ -11,6 +11,7 @@
 #include <set>
 #include <QPixmap>
 #include <QPointer>
+#include <QSharedPointer>
 #include <QTimer>
 #include <QHash>
 #include <QStringList>
@@ -42,10 +43,18 @@ struct QED2KSearchResultEntry
 	bool isCorrect() const;
 	QED2KSearchResultEntry();
     QED2KSearchResultEntry(const Preferences& pref);
-	static QED2KSearchResultEntry fromSharedFileEntry(const libed2k::shared_file_entry& sf);
+    /**
+      * decodes tags of shared file into fresh entry, returns isCorrect of result
+     */
+	static bool fromSharedFileEntry(const libed2k::shared_file_entry& sf, QED2KSearchResultEntry& sre);
     void save(Preferences& pref) const;
 };
 
+/**
+  * entries of one search or shared files answer, built once and shared by all receivers read only
+ */
+typedef QSharedPointer<const std::vector<QED2KSearchResultEntry> > QED2KSearchResultBatch;
+
 struct QED2KPeerOptions
 {
     quint8  m_nAICHVersion;
@@ -114,6 +123,9 @@ public:
 
     libed2k::session* delegate() const;
 
+protected:
+    LogRecord::Source logSource() const { return LogRecord::S_ED2K; }
+
 private:
     QScopedPointer<libed2k::session> m_session;
     QHash<QString, Transfer>      m_fast_resume_transfers;   // contains fast resume data were loading
@@ -165,7 +177,7 @@ signals:
     void serverMessage(QString strMessage);
     void serverIdentity(QString strName, QString strDescription);
     void searchResult(const libed2k::net_identifier& np, const QString& hash, 
-                      const std::vector<QED2KSearchResultEntry>& vRes, bool bMoreResult);
+                      const QED2KSearchResultBatch& vRes, bool bMoreResult);
 
     //peer signals
     void peerConnected(const libed2k::net_identifier& np,
@@ -190,10 +202,10 @@ signals:
       * requested peers files - all
      */
     void peerSharedFiles(const libed2k::net_identifier& np, const QString& hash,
-                         const std::vector<QED2KSearchResultEntry>& vRes);
+                         const QED2KSearchResultBatch& vRes);
 
     void peerIsModSharedFiles(const libed2k::net_identifier& np, const QString& hash, const QString& dir_hash,
-                              const std::vector<QED2KSearchResultEntry>& vRes);
+                              const QED2KSearchResultBatch& vRes);
 
     /**
       * requested peers shared directories
@@ -204,7 +216,7 @@ signals:
       * requested peers files from sprecified directory
      */
     void peerSharedDirectoryFiles(const libed2k::net_identifier& np, const QString& hash,
-                                  const QString& strDirectory, const std::vector<QED2KSearchResultEntry>& vRes);
+                                  const QString& strDirectory, const QED2KSearchResultBatch& vRes);
 
     void transferParametersReady(const libed2k::add_transfer_params&, const libed2k::error_code&);
     void fastResumeDataLoadCompleted();
@@ -1674,16 +1674,9 @@ void QBtSession::saveFastResumeData() {
 }
 
 void QBtSession::addPeerBanMessage(QString ip, bool from_ipfilter) {
-  if (peerBanMessages.size() > MAX_LOG_MESSAGES) {
-    peerBanMessages.removeFirst();
-  }
-  QString msg;
-  if (from_ipfilter)
-    msg = "<font color='grey'>" + QDateTime::currentDateTime().toString(QString::fromUtf8("dd/MM/yyyy hh:mm:ss")) + "</font> - " + tr("<font color='red'>%1</font> <i>was blocked due to your IP filter</i>", "x.y.z.w was blocked").arg(ip);
-  else
-    msg = "<font color='grey'>" + QDateTime::currentDateTime().toString(QString::fromUtf8("dd/MM/yyyy hh:mm:ss")) + "</font> - " + tr("<font color='red'>%1</font> <i>was banned due to corrupt pieces</i>", "x.y.z.w was banned").arg(ip);
-  peerBanMessages.append(msg);
-  emit newBanMessage(msg);
+  SessionLog::instance()->add(SessionLog::J_BAN,
+                              LogRecord(LogRecord::S_TORRENT, LogRecord::L_NOTICE,
+                                        from_ipfilter ? LogRecord::M_IP_BLOCKED : LogRecord::M_PEER_BANNED, ip));
 }
 
 void QBtSession::addTorrentsFromScanFolder(QStringList &pathList) {
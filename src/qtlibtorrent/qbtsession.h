@@ -91,7 +91,6 @@ public:
   SessionStatus getSessionStatus() const;
   QHash<QString, TrackerInfos> getTrackersInfo(const QString &hash) const;
   bool hasDownloadingTorrents() const;
-  inline QStringList getPeerBanMessages() const { return peerBanMessages; }
   inline libtorrent::session* getSession() const { return s; }
   inline bool useTemporaryFolder() const { return !defaultTempPath.isEmpty(); }
   inline QString getDefaultSavePath() const { return defaultSavePath; }
@@ -162,6 +161,9 @@ public slots:
   void banIP(QString ip);
   void recursiveTorrentDownload(const QTorrentHandle &h);
 
+protected:
+  LogRecord::Source logSource() const { return LogRecord::S_TORRENT; }
+
 private:
   QString getSavePath(const QString &hash, bool fromScanDir = false, QString filePath = QString::null, QString root_folder=QString::null);
   bool loadFastResumeData(const QString &hash, std::vector<char> &buf);
@@ -195,7 +197,6 @@ signals:
   void downloadFromUrlFailure(QString url, QString reason);
   void torrentFinishedChecking(const QTorrentHandle& h);
   void metadataReceived(const QTorrentHandle &h);
-  void newBanMessage(const QString &msg);
   void alternativeSpeedsModeChanged(bool alternative);
   void recursiveTorrentDownloadPossible(const QTorrentHandle &h);
   void ipFilterParsed(bool error, int ruleCount);
@@ -216,8 +217,6 @@ private:
   DownloadThread* downloader;
   // File System
   ScanFoldersModel *m_scanFolders;
-  // Console / Log
-  QStringList peerBanMessages;
   // Settings
   bool preAllocateAll;
   bool addInPause;
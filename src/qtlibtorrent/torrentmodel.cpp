@@ -36,7 +36,7 @@
 #include "qtorrenthandle.h"
 
 
-TorrentModelItem::TorrentModelItem(const Transfer &h) : m_torrent(h)
+TorrentModelItem::TorrentModelItem(const Transfer &h) : m_torrent(h), m_state(STATE_INVALID), m_snapshot(2*NB_COLUMNS)
 {
   m_hash = h.hash();
   m_name = TorrentPersistentData::getName(h.hash());
@@ -44,6 +44,7 @@ TorrentModelItem::TorrentModelItem(const Transfer &h) : m_torrent(h)
   m_addedTime = TorrentPersistentData::getAddedDate(h.hash());
   m_seedTime = TorrentPersistentData::getSeedDate(h.hash());
   m_label = TorrentPersistentData::getLabel(h.hash());
+  refresh();
 }
 
 TorrentModelItem::State TorrentModelItem::state() const
@@ -51,16 +52,12 @@ TorrentModelItem::State TorrentModelItem::state() const
   try {
     // Pause or Queued
     if (m_torrent.is_paused()) {
-      m_icon = QIcon(":/Icons/skin/paused.png");
-      m_fgColor = QColor("red");
       return m_torrent.is_seed() ? STATE_PAUSED_UP : STATE_PAUSED_DL;
     }
     if (m_torrent.is_queued()) {
       if (m_torrent.state() != qt_queued_for_checking
           && m_torrent.state() != qt_checking_resume_data
           && m_torrent.state() != qt_checking_files) {
-        m_icon = QIcon(":/Icons/skin/queued.png");
-        m_fgColor = QColor("grey");
         return m_torrent.is_seed() ? STATE_QUEUED_UP : STATE_QUEUED_DL;
       }
     }
@@ -68,51 +65,67 @@ TorrentModelItem::State TorrentModelItem::state() const
     switch(m_torrent.state()) {
     case qt_allocating:
     case qt_downloading_metadata:
-    case qt_downloading: {
-      if (m_torrent.download_payload_rate() > 0) {
-        m_icon = QIcon(":/Icons/skin/downloading.png");
-        m_fgColor = QColor("green");
-        return STATE_DOWNLOADING;
-      } else {
-        m_icon = QIcon(":/Icons/skin/stalledDL.png");
-        m_fgColor = QColor("grey");
-        return STATE_STALLED_DL;
-      }
-    }
+    case qt_downloading:
+      return (m_torrent.download_payload_rate() > 0) ? STATE_DOWNLOADING : STATE_STALLED_DL;
     case qt_finished:
     case qt_seeding:
-      if (m_torrent.upload_payload_rate() > 0) {
-        m_icon = QIcon(":/Icons/skin/uploading.png");
-        m_fgColor = QColor("orange");
-        return STATE_SEEDING;
-      } else {
-        m_icon = QIcon(":/Icons/skin/stalledUP.png");
-        m_fgColor = QColor("grey");
-        return STATE_STALLED_UP;
-      }
+      return (m_torrent.upload_payload_rate() > 0) ? STATE_SEEDING : STATE_STALLED_UP;
     case qt_queued_for_checking:
     case qt_checking_resume_data:
     case qt_checking_files:
-      m_icon = QIcon(":/Icons/skin/checking.png");
-      m_fgColor = QColor("grey");
       return m_torrent.is_seed() ? STATE_CHECKING_UP : STATE_CHECKING_DL;
     default:
-      m_icon = QIcon(":/Icons/skin/error.png");
-      m_fgColor = QColor("red");
       return STATE_INVALID;
     }
-  } catch(libtorrent::invalid_handle&)
-    {
-    m_icon = QIcon(":/Icons/skin/error.png");
-    m_fgColor = QColor("red");
-    return STATE_INVALID;
   }
-  catch(libed2k::libed2k_exception&)
-    {
-        m_icon = QIcon(":/Icons/skin/error.png");
-        m_fgColor = QColor("red");
-        return STATE_INVALID;
-    }
+  catch(libtorrent::invalid_handle&) {}
+  catch(libed2k::libed2k_exception&) {}
+  return STATE_INVALID;
+}
+
+// Icons and colors are shared by all items
+const QIcon& TorrentModelItem::stateIcon(State state)
+{
+  static const QIcon paused(":/Icons/skin/paused.png");
+  static const QIcon queued(":/Icons/skin/queued.png");
+  static const QIcon downloading(":/Icons/skin/downloading.png");
+  static const QIcon stalledDL(":/Icons/skin/stalledDL.png");
+  static const QIcon uploading(":/Icons/skin/uploading.png");
+  static const QIcon stalledUP(":/Icons/skin/stalledUP.png");
+  static const QIcon checking(":/Icons/skin/checking.png");
+  static const QIcon error(":/Icons/skin/error.png");
+  switch(state) {
+  case STATE_PAUSED_DL:
+  case STATE_PAUSED_UP: return paused;
+  case STATE_QUEUED_DL:
+  case STATE_QUEUED_UP: return queued;
+  case STATE_DOWNLOADING: return downloading;
+  case STATE_STALLED_DL: return stalledDL;
+  case STATE_SEEDING: return uploading;
+  case STATE_STALLED_UP: return stalledUP;
+  case STATE_CHECKING_DL:
+  case STATE_CHECKING_UP: return checking;
+  default: return error;
+  }
+}
+
+const QColor& TorrentModelItem::stateColor(State state)
+{
+  static const QColor red("red");
+  static const QColor grey("grey");
+  static const QColor green("green");
+  static const QColor orange("orange");
+  switch(state) {
+  case STATE_DOWNLOADING: return green;
+  case STATE_SEEDING: return orange;
+  case STATE_STALLED_DL:
+  case STATE_STALLED_UP:
+  case STATE_QUEUED_DL:
+  case STATE_QUEUED_UP:
+  case STATE_CHECKING_DL:
+  case STATE_CHECKING_UP: return grey;
+  default: return red;
+  }
 }
 
 bool TorrentModelItem::setData(int column, const QVariant &value, int role)
@@ -143,13 +156,22 @@ bool TorrentModelItem::setData(int column, const QVariant &value, int role)
 
 QVariant TorrentModelItem::data(int column, int role) const
 {
-  if (role == Qt::DecorationRole && column == TR_NAME) {
-    return m_icon;
-  }
-  if (role == Qt::ForegroundRole) {
-    return m_fgColor;
+  switch(role) {
+  case Qt::DecorationRole:
+    return (column == TR_NAME) ? stateIcon(m_state) : QVariant();
+  case Qt::ForegroundRole:
+    return stateColor(m_state);
+  case Qt::DisplayRole:
+    return m_snapshot[2*column];
+  case Qt::UserRole:
+    return hasSortValue(column) ? m_snapshot[2*column+1] : m_snapshot[2*column];
+  default:
+    return QVariant();
   }
-  if (role != Qt::DisplayRole && role != Qt::UserRole) return QVariant();
+}
+
+QVariant TorrentModelItem::value(int column, int role) const
+{
   if (!m_torrent.is_valid()) return QVariant();
   switch(column) {
   case TR_NAME:
@@ -161,7 +183,7 @@ QVariant TorrentModelItem::data(int column, int role) const
   case TR_PROGRESS:
     return m_torrent.progress();
   case TR_STATUS:
-    return state();
+    return m_state;
   case TR_SEEDS: {
     return (role == Qt::DisplayRole) ? m_torrent.num_seeds() : m_torrent.num_complete();
   }
@@ -202,6 +224,33 @@ QVariant TorrentModelItem::data(int column, int role) const
   }
 }
 
+uint TorrentModelItem::refresh()
+{
+  uint changed = 0;
+  const State previous = m_state;
+  m_state = state();
+  for (int column = 0; column < NB_COLUMNS; ++column) {
+    QVariant value;
+    QVariant user_value;
+    try {
+      value = this->value(column, Qt::DisplayRole);
+      if (hasSortValue(column))
+        user_value = this->value(column, Qt::UserRole);
+    }
+    catch(libtorrent::invalid_handle&) {}
+    catch(libed2k::libed2k_exception&) {}
+    if (value != m_snapshot[2*column] || user_value != m_snapshot[2*column+1]) {
+      m_snapshot[2*column] = value;
+      m_snapshot[2*column+1] = user_value;
+      changed |= (1u << column);
+    }
+  }
+  // Icon and foreground color of all columns follow the state
+  if (m_state != previous)
+    changed = (1u << NB_COLUMNS) - 1;
+  return changed;
+}
+
 // TORRENT MODEL
 
 TorrentModel::TorrentModel(QObject *parent) :
@@ -333,14 +382,7 @@ bool TorrentModel::setData(const QModelIndex &index, const QVariant &value, int
 
 int TorrentModel::torrentRow(const QString &hash) const
 {
-  QList<TorrentModelItem*>::const_iterator it;  
-  int row = 0;
-    for (it = m_torrents.constBegin(); it != m_torrents.constEnd(); it++)
-    {
-        if ((*it)->hash() == hash) return row;
-        ++row;
-    }
-  return -1;
+  return m_rows.value(hash, -1);
 }
 
 void TorrentModel::addTorrent(const Transfer& h)
@@ -360,9 +402,13 @@ void TorrentModel::addTorrent(const Transfer& h)
     TorrentModelItem *item = new TorrentModelItem(h);
     connect(item, SIGNAL(labelChanged(QString,QString)),
             SLOT(handleTorrentLabelChange(QString,QString)));
+    m_rows.insert(item->hash(), m_torrents.size());
     m_torrents << item;
     emit torrentAdded(item);
     endInsertTorrent();
+    updateReport(item->data(TorrentModelItem::TR_STATUS).toInt(), 1);
+    emit statusReportChanged();
+    updateLabelCount(item->data(TorrentModelItem::TR_LABEL).toString(), 1);
   }
 }
 
@@ -372,8 +418,15 @@ void TorrentModel::removeTorrent(const QString &hash)
   qDebug() << Q_FUNC_INFO << hash << row;
   if (row >= 0) {
     beginRemoveTorrent(row);
-    m_torrents.removeAt(row);
+    TorrentModelItem *item = m_torrents.takeAt(row);
+    m_rows.remove(hash);
+    // Shift rows of following torrents
+    for (int i = row; i < m_torrents.size(); ++i)
+      m_rows[m_torrents.at(i)->hash()] = i;
     endRemoveTorrent();
+    updateReport(item->data(TorrentModelItem::TR_STATUS).toInt(), -1);
+    emit statusReportChanged();
+    updateLabelCount(item->data(TorrentModelItem::TR_LABEL).toString(), -1);
   }
 }
 
@@ -425,6 +478,8 @@ void TorrentModel::handleTorrentUpdate(const Transfer& h)
 
 void TorrentModel::notifyTorrentChanged(int row)
 {
+  if (refreshItem(row) & (1u << TorrentModelItem::TR_STATUS))
+    emit statusReportChanged();
   emit dataChanged(index(row, 0), index(row, columnCount()-1));
 }
 
@@ -440,46 +495,78 @@ void TorrentModel::setRefreshInterval(int refreshInterval)
 void TorrentModel::forceModelRefresh()
 {
   processPendingTransfers();
-  emit dataChanged(index(0, 0), index(rowCount()-1, columnCount()-1));
+  // Notify only changed cells, proxies re-sort and re-filter these rows only
+  bool states_changed = false;
+  for (int row = 0; row < m_torrents.size(); ++row) {
+    const uint changed = refreshItem(row);
+    if (!changed) continue;
+    if (changed & (1u << TorrentModelItem::TR_STATUS))
+      states_changed = true;
+    int first = 0;
+    while (!(changed & (1u << first))) ++first;
+    int last = columnCount() - 1;
+    while (!(changed & (1u << last))) --last;
+    emit dataChanged(index(row, first), index(row, last));
+  }
+  if (states_changed)
+    emit statusReportChanged();
 }
 
-TorrentStatusReport TorrentModel::getTorrentStatusReport() const
+uint TorrentModel::refreshItem(int row)
 {
-  TorrentStatusReport report;
-  QList<TorrentModelItem*>::const_iterator it;
-  for (it = m_torrents.constBegin(); it != m_torrents.constEnd(); it++) {
-    switch((*it)->data(TorrentModelItem::TR_STATUS).toInt()) {
-    case TorrentModelItem::STATE_DOWNLOADING:
-      ++report.nb_active;
-      ++report.nb_downloading;
-      break;
-    case TorrentModelItem::STATE_PAUSED_DL:
-      ++report.nb_paused;
-    case TorrentModelItem::STATE_STALLED_DL:
-    case TorrentModelItem::STATE_CHECKING_DL:
-    case TorrentModelItem::STATE_QUEUED_DL: {
-      ++report.nb_inactive;
-      ++report.nb_downloading;
-      break;
-    }
-    case TorrentModelItem::STATE_SEEDING:
-      ++report.nb_active;
-      ++report.nb_seeding;
-      break;
-    case TorrentModelItem::STATE_PAUSED_UP:
-      ++report.nb_paused;
-    case TorrentModelItem::STATE_STALLED_UP:
-    case TorrentModelItem::STATE_CHECKING_UP:
-    case TorrentModelItem::STATE_QUEUED_UP: {
-      ++report.nb_seeding;
-      ++report.nb_inactive;
-      break;
-    }
-    default:
-      break;
-    }
+  TorrentModelItem *item = m_torrents.at(row);
+  const int previous = item->data(TorrentModelItem::TR_STATUS).toInt();
+  const uint changed = item->refresh();
+  if (changed & (1u << TorrentModelItem::TR_STATUS)) {
+    updateReport(previous, -1);
+    updateReport(item->data(TorrentModelItem::TR_STATUS).toInt(), 1);
   }
-  return report;
+  return changed;
+}
+
+void TorrentModel::updateReport(int state, int delta)
+{
+  switch(state) {
+  case TorrentModelItem::STATE_DOWNLOADING:
+    m_report.nb_active += delta;
+    m_report.nb_downloading += delta;
+    break;
+  case TorrentModelItem::STATE_PAUSED_DL:
+    m_report.nb_paused += delta;
+  case TorrentModelItem::STATE_STALLED_DL:
+  case TorrentModelItem::STATE_CHECKING_DL:
+  case TorrentModelItem::STATE_QUEUED_DL: {
+    m_report.nb_inactive += delta;
+    m_report.nb_downloading += delta;
+    break;
+  }
+  case TorrentModelItem::STATE_SEEDING:
+    m_report.nb_active += delta;
+    m_report.nb_seeding += delta;
+    break;
+  case TorrentModelItem::STATE_PAUSED_UP:
+    m_report.nb_paused += delta;
+  case TorrentModelItem::STATE_STALLED_UP:
+  case TorrentModelItem::STATE_CHECKING_UP:
+  case TorrentModelItem::STATE_QUEUED_UP: {
+    m_report.nb_seeding += delta;
+    m_report.nb_inactive += delta;
+    break;
+  }
+  default:
+    break;
+  }
+}
+
+void TorrentModel::updateLabelCount(const QString &label, int delta)
+{
+  const int count = m_labelCounts.value(label, 0) + delta;
+  Q_ASSERT(count >= 0);
+  if (count > 0)
+    m_labelCounts.insert(label, count);
+  else
+    m_labelCounts.remove(label);
+  emit labelCountChanged(label);
 }
 
 Qt::ItemFlags TorrentModel::flags(const QModelIndex &index) const
@@ -493,6 +580,8 @@ Qt::ItemFlags TorrentModel::flags(const QModelIndex &index) const
 void TorrentModel::handleTorrentLabelChange(QString previous, QString current)
 {
   emit torrentChangedLabel(static_cast<TorrentModelItem*>(sender()), previous, current);
+  updateLabelCount(previous, -1);
+  updateLabelCount(current, 1);
 }
 
 QString TorrentModel::torrentHash(int row) const
@@ -33,6 +33,8 @@
 
 #include <QAbstractListModel>
 #include <QList>
+#include <QHash>
+#include <QVector>
 #include <QDateTime>
 #include <QIcon>
 #include <QTimer>
@@ -54,25 +56,33 @@ public:
 public:
   TorrentModelItem(const Transfer& h);
   inline int columnCount() const { return NB_COLUMNS; }
+  // Reads values of last refresh
   QVariant data(int column, int role = Qt::DisplayRole) const;
   bool setData(int column, const QVariant &value, int role = Qt::DisplayRole);
   inline QString hash() const { return m_hash; }
+  // Takes state and values from transfer once, returns mask of changed columns
+  uint refresh();
 
 signals:
   void labelChanged(QString previous, QString current);
 
 private:
   State state() const;
+  QVariant value(int column, int role) const;
+  static const QIcon& stateIcon(State state);
+  static const QColor& stateColor(State state);
+  // Only these columns have different sort values
+  static bool hasSortValue(int column) { return column == TR_SEEDS || column == TR_PEERS || column == TR_TIME_ELAPSED; }
 
 private:
   Transfer m_torrent;
+  State m_state;
   QDateTime m_addedTime;
   QDateTime m_seedTime;
   QString m_label;
   QString m_name;
-  mutable QIcon m_icon;
-  mutable QColor m_fgColor;
   QString m_hash; // Cached for safety reasons
+  QVector<QVariant> m_snapshot; // Display and user role values per column
 };
 
 class TorrentModel : public QAbstractListModel
@@ -91,7 +101,9 @@ public:
   int torrentRow(const QString &hash) const;
   QString torrentHash(int row) const;
   void setRefreshInterval(int refreshInterval);
-  TorrentStatusReport getTorrentStatusReport() const;
+  // Counters are kept up to date on row state and label changes
+  TorrentStatusReport getTorrentStatusReport() const { return m_report; }
+  int labelCount(const QString &label) const { return m_labelCounts.value(label, 0); }
   Qt::ItemFlags flags(const QModelIndex &index) const;
   void populate();
 
@@ -99,6 +111,8 @@ signals:
   void torrentAdded(TorrentModelItem *torrentItem);
   void torrentAboutToBeRemoved(TorrentModelItem *torrentItem);
   void torrentChangedLabel(TorrentModelItem *torrentItem, QString previous, QString current);
+  void statusReportChanged();
+  void labelCountChanged(const QString &label);
 
 public slots:
   void removeTorrent(const QString& hash);
@@ -117,9 +131,15 @@ private:
   void beginRemoveTorrent(int row);
   void endRemoveTorrent();
   void processPendingTransfers();
+  uint refreshItem(int row);
+  void updateReport(int state, int delta);
+  void updateLabelCount(const QString &label, int delta);
 
 private:
   QList<TorrentModelItem*> m_torrents;
+  QHash<QString, int> m_rows; // hash -> row in m_torrents
+  TorrentStatusReport m_report;
+  QHash<QString, int> m_labelCounts; // label -> number of torrents, empty label for unlabeled
   QList<Transfer> m_pendingTransfers;
   int m_refreshInterval;
   QTimer m_refreshTimer;
@@ -29,7 +29,6 @@
  */
 
 #include <QMutexLocker>
-#include <QList>
 #include <vector>
 
 #include "transport/session.h"
@@ -38,95 +37,145 @@
 
 using namespace libtorrent;
 
+// Rings of last payload rates with their exponentially weighted moving averages
 class SpeedSample {
 
 public:
-  SpeedSample() {}
-  void addSample(int s);
-  qreal average() const;
-  void clear();
+  SpeedSample();
+  void addSample(int download, int upload);
+  qreal download() const { return m_download; }
+  qreal upload() const { return m_upload; }
+  // Nothing was downloaded during whole stall window
+  bool stalled() const;
+  qlonglong eta(qlonglong remaining) const;
 
 private:
   static const int max_samples = 30;
+  static const int stall_window = 10;
 
 private:
-  QList<int> m_speedSamples;
+  int m_downloads[max_samples];
+  int m_uploads[max_samples];
+  int m_pos;   // slot of next sample
+  int m_count;
+  qreal m_download;
+  qreal m_upload;
 };
 
-TorrentSpeedMonitor::TorrentSpeedMonitor(Session* session) :
-  QThread(session), m_abort(false), m_session(session)
+// Weight of new sample, average follows about as fast as mean of max_samples
+static const qreal ewma_alpha = 2. / 31;
+
+SpeedSample::SpeedSample() : m_pos(0), m_count(0), m_download(0), m_upload(0)
 {
-  connect(m_session, SIGNAL(deletedTransfer(QString)), SLOT(removeSamples(QString)));
-  connect(m_session, SIGNAL(pausedTransfer(Transfer)), SLOT(removeSamples(Transfer)));
 }
 
-TorrentSpeedMonitor::~TorrentSpeedMonitor() {
-  m_abort = true;
-  m_abortCond.wakeOne();
-  wait();
+void SpeedSample::addSample(int download, int upload)
+{
+  // Average decayed during stall is far below speed of resumed download
+  const bool restart = (m_count == 0) || (download > 0 && stalled());
+
+  m_downloads[m_pos] = download;
+  m_uploads[m_pos] = upload;
+  m_pos = (m_pos + 1) % max_samples;
+  if (m_count < max_samples)
+    ++m_count;
+
+  if (restart) {
+    m_download = download;
+    m_upload = upload;
+  } else {
+    m_download += ewma_alpha * (download - m_download);
+    m_upload += ewma_alpha * (upload - m_upload);
+  }
 }
 
-void TorrentSpeedMonitor::run()
+bool SpeedSample::stalled() const
 {
-  do {
-    m_mutex.lock();
-    getSamples();
-    m_abortCond.wait(&m_mutex, 1000);
-    m_mutex.unlock();
-  } while(!m_abort);
+  if (m_count < stall_window) return false;
+  for (int i = 1; i <= stall_window; ++i) {
+    if (m_downloads[(m_pos - i + max_samples) % max_samples] > 0)
+      return false;
+  }
+  return true;
 }
 
-void SpeedSample::addSample(int s)
+qlonglong SpeedSample::eta(qlonglong remaining) const
 {
-  m_speedSamples << s;
-  if (m_speedSamples.size() > max_samples)
-    m_speedSamples.removeFirst();
+  if (remaining <= 0) return 0;
+  if (stalled() || m_download < 1) return -1;
+  return remaining / m_download;
 }
 
-qreal SpeedSample::average() const
+TorrentSpeedMonitor::TorrentSpeedMonitor(Session* session) :
+  QThread(session), m_abort(false), m_session(session)
 {
-  if (m_speedSamples.empty()) return 0;
-  qlonglong sum = 0;
-  foreach (int s, m_speedSamples) {
-    sum += s;
+  qRegisterMetaType<TransferSpeeds>("TransferSpeeds");
+  connect(this, SIGNAL(speedsReady(TransferSpeeds)), SLOT(publish(TransferSpeeds)), Qt::QueuedConnection);
+}
+
+TorrentSpeedMonitor::~TorrentSpeedMonitor() {
+  {
+    QMutexLocker locker(&m_mutex);
+    m_abort = true;
+    m_abortCond.wakeOne();
   }
-  return sum/static_cast<float>(m_speedSamples.size());
+  wait();
 }
 
-void SpeedSample::clear()
+void TorrentSpeedMonitor::run()
 {
-  m_speedSamples.clear();
+  QMutexLocker locker(&m_mutex);
+  while (!m_abort) {
+    locker.unlock();
+    getSamples();
+    locker.relock();
+    if (!m_abort)
+      m_abortCond.wait(&m_mutex, sampling_interval);
+  }
 }
 
-void TorrentSpeedMonitor::removeSamples(const QString &hash)
+void TorrentSpeedMonitor::publish(const TransferSpeeds& speeds)
 {
-  m_samples.remove(hash);
+  m_speeds = speeds;
 }
 
-void TorrentSpeedMonitor::removeSamples(const Transfer& h) {
-  try {
-    m_samples.remove(h.hash());
-  } catch(invalid_handle&) {}
+qlonglong TorrentSpeedMonitor::getETA(const QString &hash) const
+{
+  return getSpeed(hash).eta;
 }
 
-qlonglong TorrentSpeedMonitor::getETA(const QString &hash) const
+TransferSpeed TorrentSpeedMonitor::getSpeed(const QString &hash) const
 {
-  QMutexLocker locker(&m_mutex);
-  Transfer h = m_session->getTransfer(hash);
-  if (!h.is_valid() || h.is_paused() || !m_samples.contains(hash)) return -1;
-  const qreal speed_average = m_samples.value(hash).average();
-  if (speed_average == 0) return -1;
-  return (h.total_wanted() - h.total_done()) / speed_average;
+  return m_speeds ? m_speeds->value(hash) : TransferSpeed();
 }
 
 void TorrentSpeedMonitor::getSamples()
 {
-  const std::vector<Transfer> torrents = m_session->getActiveTransfers();
+  const std::vector<Transfer> transfers = m_session->getActiveTransfers();
+  QHash<QString, SpeedSample> samples;
+  QSharedPointer<QHash<QString, TransferSpeed> > speeds(new QHash<QString, TransferSpeed>());
+  samples.reserve(transfers.size());
+  speeds->reserve(transfers.size());
+
   std::vector<Transfer>::const_iterator it;
-  for (it = torrents.begin(); it != torrents.end(); it++) {
+  for (it = transfers.begin(); it != transfers.end(); it++) {
     try {
-      if (!it->is_paused())
-        m_samples[it->hash()].addSample(it->status().download_payload_rate);
+      // One status per transfer gives rates and remaining size of same moment
+      const TransferStatus status = it->status();
+      if (status.paused) continue;
+      const QString hash = it->hash();
+      SpeedSample sample = m_samples.value(hash);
+      sample.addSample(status.download_payload_rate, status.upload_payload_rate);
+      samples.insert(hash, sample);
+
+      TransferSpeed& speed = (*speeds)[hash];
+      speed.eta = sample.eta(status.total_wanted - status.total_done);
+      speed.download = sample.download();
+      speed.upload = sample.upload();
     } catch(invalid_handle&) {}
   }
+
+  // Samples of paused and deleted transfers are dropped here
+  m_samples = samples;
+  emit speedsReady(speeds);
 }
@@ -36,11 +36,27 @@
 #include <QWaitCondition>
 #include <QHash>
 #include <QMutex>
+#include <QSharedPointer>
+#include <QMetaType>
 
 class Session;
-class Transfer;
 class SpeedSample;
 
+// Estimate of active transfer made on last sampling
+struct TransferSpeed
+{
+  TransferSpeed() : eta(-1), download(0), upload(0) {}
+
+  qlonglong eta;  // seconds, -1 when unknown or download is stalled
+  qreal download; // moving averages of payload rates
+  qreal upload;
+};
+
+typedef QSharedPointer<const QHash<QString, TransferSpeed> > TransferSpeeds;
+Q_DECLARE_METATYPE(TransferSpeeds)
+
+// Samples rates of bittorrent and ed2k transfers once a second on own thread.
+// Estimates are published to main thread as read-only batch, readers don't lock
 class TorrentSpeedMonitor : public QThread
 {
   Q_OBJECT
@@ -49,6 +65,7 @@ public:
   explicit TorrentSpeedMonitor(Session* session);
   ~TorrentSpeedMonitor();
   qlonglong getETA(const QString &hash) const;
+  TransferSpeed getSpeed(const QString &hash) const;
 
 protected:
   void run();
@@ -57,8 +74,10 @@ private:
   void getSamples();
 
 private slots:
-  void removeSamples(const QString& hash);
-  void removeSamples(const Transfer& h);
+  void publish(const TransferSpeeds& speeds);
+
+signals:
+  void speedsReady(const TransferSpeeds& speeds);
 
 private:
   static const int sampling_interval = 1000; // 1s
@@ -66,8 +85,9 @@ private:
 private:
   bool m_abort;
   QWaitCondition m_abortCond;
-  QHash<QString, SpeedSample> m_samples;
-  mutable QMutex m_mutex;
+  QMutex m_mutex; // guards m_abort only
+  QHash<QString, SpeedSample> m_samples; // monitor thread only
+  TransferSpeeds m_speeds; // main thread only
   Session *m_session;
 };
 
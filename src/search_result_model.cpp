@@ -0,0 +1,500 @@
+#include <QCoreApplication>
+
+#include "search_result_model.h"
+#include "misc.h"
+
+#include "libed2k/file.hpp"
+
+using namespace libed2k;
+
+namespace
+{
+    inline quint16 bit(int column) { return quint16(1) << column; }
+
+    template<typename T>
+    inline int compareValues(const T& v1, const T& v2)
+    {
+        return (v1 < v2) ? -1 : ((v2 < v1) ? 1 : 0);
+    }
+}
+
+void SearchResultModel::Rows::append()
+{
+    name.append(0);
+    size.append(0);
+    availability.append(0);
+    sources.append(0);
+    type.append(-1);
+    hash.append(QString());
+    duration.append(0);
+    bitrate.append(0);
+    codec.append(0);
+    icon.append(IK_NONE);
+    flags.append(0);
+    columns.append(0);
+}
+
+void SearchResultModel::Rows::clear()
+{
+    *this = Rows();
+}
+
+SearchResultModel::SearchResultModel(QObject* parent /*= 0*/) :
+    QAbstractItemModel(parent), m_icons(IK_NUM), m_headers(SWDelegate::SW_COLUMNS_NUM), m_filling(false)
+{
+    // empty string always has id 0
+    intern(QString());
+}
+
+void SearchResultModel::setIcon(IconKind kind, const QIcon& icon)
+{
+    m_icons[kind] = icon;
+}
+
+void SearchResultModel::beginFill()
+{
+    beginResetModel();
+    m_filling = true;
+    m_rows.clear();
+    m_children.clear();
+    m_pool.clear();
+    m_poolIds.clear();
+    intern(QString());
+}
+
+void SearchResultModel::endFill()
+{
+    m_children.resize(m_rows.count());
+    m_filling = false;
+    endResetModel();
+}
+
+void SearchResultModel::beginAppend(int count)
+{
+    Q_ASSERT(count > 0);
+    beginInsertRows(QModelIndex(), m_rows.count(), m_rows.count() + count - 1);
+    m_filling = true;
+}
+
+void SearchResultModel::endAppend()
+{
+    m_children.resize(m_rows.count());
+    m_filling = false;
+    endInsertRows();
+}
+
+void SearchResultModel::addFile(const QED2KSearchResultEntry& entry)
+{
+    appendFile(m_rows, entry);
+}
+
+void SearchResultModel::addClient(const QED2KSearchResultEntry& entry, bool connected)
+{
+    m_rows.append();
+    const int row = m_rows.count() - 1;
+
+    QString user_name = entry.m_strFilename;
+    user_name.replace("+++USERNICK+++", "");
+    m_rows.name[row] = intern(user_name.trimmed());
+    // for users size calculated from
+    // m_nMediaLength  - low part of real size
+    // m_nMediaBitrate - high part of real size
+    m_rows.size[row] = ((quint64)entry.m_nMediaBitrate << 32) + (unsigned int)entry.m_nMediaLength;
+    m_rows.hash[row] = entry.m_hFile;
+    m_rows.icon[row] = connected ? IK_USER_CONNECTED : IK_USER;
+    m_rows.columns[row] = bit(SWDelegate::SW_NAME) | bit(SWDelegate::SW_SIZE) | bit(SWDelegate::SW_ID);
+}
+
+int SearchResultModel::addFolder(const QString& path, qint64 size, qint64 availability, const QString& hash)
+{
+    m_rows.append();
+    const int row = m_rows.count() - 1;
+
+    m_rows.name[row] = intern(path);
+    m_rows.icon[row] = IK_FOLDER;
+    m_rows.columns[row] = bit(SWDelegate::SW_NAME);
+
+    if (size >= 0)
+    {
+        m_rows.size[row] = size;
+        m_rows.columns[row] |= bit(SWDelegate::SW_SIZE);
+    }
+
+    if (availability >= 0)
+    {
+        m_rows.availability[row] = availability;
+        m_rows.columns[row] |= bit(SWDelegate::SW_AVAILABILITY);
+    }
+
+    if (!hash.isEmpty())
+    {
+        m_rows.hash[row] = hash;
+        m_rows.columns[row] |= bit(SWDelegate::SW_ID);
+    }
+
+    m_children.resize(m_rows.count());
+    return row;
+}
+
+void SearchResultModel::setFolderFiles(int row, const std::vector<QED2KSearchResultEntry>& files)
+{
+    Q_ASSERT(row >= 0 && row < m_rows.count());
+    removeChildren(row);
+
+    quint64 size = 0;
+    for (std::vector<QED2KSearchResultEntry>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+        size += itr->m_nFilesize;
+
+    m_rows.size[row] = size;
+    m_rows.availability[row] = files.size();
+    m_rows.columns[row] |= bit(SWDelegate::SW_SIZE) | bit(SWDelegate::SW_AVAILABILITY);
+    if (!m_filling)
+        emit dataChanged(index(row, 0), index(row, SWDelegate::SW_COLUMNS_NUM - 1));
+
+    if (files.empty()) return;
+
+    if (!m_filling)
+        beginInsertRows(index(row, 0), 0, files.size() - 1);
+
+    Rows& children = m_children[row];
+    for (std::vector<QED2KSearchResultEntry>::const_iterator itr = files.begin(); itr != files.end(); ++itr)
+        appendFile(children, *itr);
+
+    if (!m_filling)
+        endInsertRows();
+}
+
+void SearchResultModel::addPlaceholder(int row)
+{
+    Q_ASSERT(row >= 0 && row < m_rows.count());
+    m_children.resize(m_rows.count());
+    m_children[row].append();
+}
+
+void SearchResultModel::removeChildren(int row)
+{
+    Q_ASSERT(row >= 0 && row < m_rows.count());
+    if (row >= m_children.size() || m_children[row].count() == 0) return;
+
+    if (m_filling)
+    {
+        m_children[row].clear();
+        return;
+    }
+
+    beginRemoveRows(index(row, 0), 0, m_children[row].count() - 1);
+    m_children[row].clear();
+    endRemoveRows();
+}
+
+void SearchResultModel::setSources(int row, quint64 availability, quint64 sources)
+{
+    Q_ASSERT(row >= 0 && row < m_rows.count());
+    m_rows.availability[row] = availability;
+    m_rows.sources[row] = sources;
+    emit dataChanged(index(row, 0), index(row, SWDelegate::SW_COLUMNS_NUM - 1));
+}
+
+void SearchResultModel::setClientConnected(const QString& hash, bool connected)
+{
+    int row = findRow(SWDelegate::SW_ID, hash);
+    if (row < 0) return;
+
+    m_rows.icon[row] = connected ? IK_USER_CONNECTED : IK_USER;
+    emit dataChanged(index(row, SWDelegate::SW_NAME), index(row, SWDelegate::SW_NAME));
+}
+
+void SearchResultModel::transferChanged(const QString& hash)
+{
+    for (int row = m_rows.hash.indexOf(hash); row >= 0; row = m_rows.hash.indexOf(hash, row + 1))
+        emit dataChanged(index(row, 0), index(row, SWDelegate::SW_COLUMNS_NUM - 1));
+
+    for (int parent = 0; parent < m_children.size(); ++parent)
+    {
+        const Rows& children = m_children.at(parent);
+        for (int row = children.hash.indexOf(hash); row >= 0; row = children.hash.indexOf(hash, row + 1))
+        {
+            QModelIndex parent_index = index(parent, 0);
+            emit dataChanged(index(row, 0, parent_index), index(row, SWDelegate::SW_COLUMNS_NUM - 1, parent_index));
+        }
+    }
+}
+
+int SearchResultModel::findRow(SWDelegate::Column column, const QString& value) const
+{
+    Q_ASSERT(column == SWDelegate::SW_NAME || column == SWDelegate::SW_ID);
+
+    if (column == SWDelegate::SW_NAME)
+    {
+        // strings are interned, compare ids
+        QHash<QString, int>::const_iterator itr = m_poolIds.find(value);
+        if (itr == m_poolIds.end()) return -1;
+        return m_rows.name.indexOf(itr.value());
+    }
+
+    return m_rows.hash.indexOf(value);
+}
+
+bool SearchResultModel::isTorrentLink(const QModelIndex& index) const
+{
+    if (!index.isValid()) return false;
+    return rowsOf(index).flags.at(index.row()) & FLAG_TORRENT;
+}
+
+bool SearchResultModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    Q_ASSERT(left.column() == right.column());
+    const Rows& r1 = rowsOf(left);
+    const Rows& r2 = rowsOf(right);
+    const int row1 = left.row();
+    const int row2 = right.row();
+    const int column = left.column();
+
+    // empty value goes first as QVariant comparison does
+    const bool set1 = r1.columns.at(row1) & bit(column);
+    const bool set2 = r2.columns.at(row2) & bit(column);
+    if (!set1 || !set2) return !set1 && set2;
+
+    int res = 0;
+
+    switch (column)
+    {
+        case SWDelegate::SW_NAME:
+            if (r1.name.at(row1) != r2.name.at(row2))
+                res = QString::compare(m_pool.at(r1.name.at(row1)), m_pool.at(r2.name.at(row2)), Qt::CaseInsensitive);
+            break;
+        case SWDelegate::SW_SIZE:
+            res = compareValues(r1.size.at(row1), r2.size.at(row2));
+            break;
+        case SWDelegate::SW_AVAILABILITY:
+            res = compareValues(r1.availability.at(row1), r2.availability.at(row2));
+            break;
+        case SWDelegate::SW_SOURCES:
+            res = compareValues(r1.sources.at(row1), r2.sources.at(row2));
+            break;
+        case SWDelegate::SW_TYPE:
+            if (r1.type.at(row1) != r2.type.at(row2))
+                res = QString::compare(typeName(r1.type.at(row1)), typeName(r2.type.at(row2)), Qt::CaseInsensitive);
+            break;
+        case SWDelegate::SW_ID:
+            res = QString::compare(r1.hash.at(row1), r2.hash.at(row2), Qt::CaseInsensitive);
+            break;
+        case SWDelegate::SW_DURATION:
+            res = compareValues(r1.duration.at(row1), r2.duration.at(row2));
+            break;
+        case SWDelegate::SW_BITRATE:
+            res = compareValues(r1.bitrate.at(row1), r2.bitrate.at(row2));
+            break;
+        case SWDelegate::SW_CODEC:
+            if (r1.codec.at(row1) != r2.codec.at(row2))
+                res = QString::compare(m_pool.at(r1.codec.at(row1)), m_pool.at(r2.codec.at(row2)), Qt::CaseInsensitive);
+            break;
+        default:
+            break;
+    }
+
+    return res < 0;
+}
+
+int SearchResultModel::columnCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    Q_UNUSED(parent);
+    return SWDelegate::SW_COLUMNS_NUM;
+}
+
+int SearchResultModel::rowCount(const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    if (!parent.isValid())
+        return m_rows.count();
+
+    // files of folders have no children
+    if (parent.internalId() != 0 || parent.column() != 0 || parent.row() >= m_children.size())
+        return 0;
+
+    return m_children.at(parent.row()).count();
+}
+
+QModelIndex SearchResultModel::index(int row, int column, const QModelIndex& parent /*= QModelIndex()*/) const
+{
+    if (row < 0 || column < 0 || column >= SWDelegate::SW_COLUMNS_NUM)
+        return QModelIndex();
+
+    if (!parent.isValid())
+        return (row < m_rows.count()) ? createIndex(row, column, quint32(0)) : QModelIndex();
+
+    if (parent.internalId() != 0 || parent.row() >= m_children.size() ||
+        row >= m_children.at(parent.row()).count())
+        return QModelIndex();
+
+    // internal id of child is parent row + 1
+    return createIndex(row, column, quint32(parent.row() + 1));
+}
+
+QModelIndex SearchResultModel::parent(const QModelIndex& index) const
+{
+    if (!index.isValid() || index.internalId() == 0)
+        return QModelIndex();
+
+    return createIndex(int(index.internalId() - 1), 0, quint32(0));
+}
+
+QVariant SearchResultModel::data(const QModelIndex& index, int role /*= Qt::DisplayRole*/) const
+{
+    if (!index.isValid())
+        return QVariant();
+
+    const Rows& rows = rowsOf(index);
+
+    switch (role)
+    {
+        case Qt::DisplayRole:
+            return value(rows, index.row(), index.column());
+        case Qt::DecorationRole:
+            if (index.column() == SWDelegate::SW_NAME && rows.icon.at(index.row()) != IK_NONE)
+                return m_icons.at(rows.icon.at(index.row()));
+            break;
+        case Qt::ForegroundRole:
+            if (index.column() == SWDelegate::SW_NAME)
+                return QVariant(itemColor(index));
+            break;
+        default:
+            break;
+    }
+
+    return QVariant();
+}
+
+QVariant SearchResultModel::headerData(int section, Qt::Orientation orientation, int role /*= Qt::DisplayRole*/) const
+{
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section >= 0 && section < m_headers.size())
+        return m_headers.at(section);
+
+    return QVariant();
+}
+
+bool SearchResultModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role /*= Qt::EditRole*/)
+{
+    if (orientation != Qt::Horizontal || section < 0 || section >= m_headers.size() ||
+        (role != Qt::EditRole && role != Qt::DisplayRole))
+        return false;
+
+    m_headers[section] = value.toString();
+    emit headerDataChanged(orientation, section, section);
+    return true;
+}
+
+int SearchResultModel::intern(const QString& str)
+{
+    QHash<QString, int>::const_iterator itr = m_poolIds.find(str);
+    if (itr != m_poolIds.end()) return itr.value();
+
+    m_pool.append(str);
+    m_poolIds.insert(str, m_pool.size() - 1);
+    return m_pool.size() - 1;
+}
+
+void SearchResultModel::appendFile(Rows& rows, const QED2KSearchResultEntry& entry)
+{
+    rows.append();
+    const int row = rows.count() - 1;
+
+    rows.name[row] = intern(entry.m_strFilename);
+    rows.size[row] = entry.m_nFilesize;
+    rows.sources[row] = entry.m_nCompleteSources;
+    rows.availability[row] = entry.m_nSources;
+    rows.hash[row] = entry.m_hFile;
+    rows.columns[row] = bit(SWDelegate::SW_NAME) | bit(SWDelegate::SW_SIZE) |
+        bit(SWDelegate::SW_SOURCES) | bit(SWDelegate::SW_AVAILABILITY) | bit(SWDelegate::SW_ID);
+
+    EED2KFileType fileType = GetED2KFileTypeID(entry.m_strFilename.toStdString());
+    IconKind icon = IK_ANY;
+
+    switch (fileType)
+    {
+        case ED2KFT_AUDIO:              icon = IK_AUDIO; break;
+        case ED2KFT_VIDEO:              icon = IK_VIDEO; break;
+        case ED2KFT_IMAGE:              icon = IK_PICTURE; break;
+        case ED2KFT_PROGRAM:            icon = IK_PROGRAM; break;
+        case ED2KFT_DOCUMENT:           icon = IK_DOCUMENT; break;
+        case ED2KFT_ARCHIVE:            icon = IK_ARCHIVE; break;
+        case ED2KFT_CDIMAGE:            icon = IK_CDIMAGE; break;
+        case ED2KFT_EMULECOLLECTION:    icon = IK_COLLECTION; break;
+        default:
+            // don't set icon for torrent links
+            if (misc::isTorrentLink(entry.m_strFilename))
+            {
+                icon = IK_NONE;
+                rows.flags[row] |= FLAG_TORRENT;
+            }
+    }
+
+    rows.icon[row] = icon;
+
+    if (icon != IK_ANY && icon != IK_NONE)
+    {
+        rows.type[row] = fileType;
+        rows.columns[row] |= bit(SWDelegate::SW_TYPE);
+    }
+
+    if (fileType == ED2KFT_AUDIO || fileType == ED2KFT_VIDEO)
+    {
+        rows.duration[row] = entry.m_nMediaLength;
+        rows.bitrate[row] = entry.m_nMediaBitrate;
+        rows.columns[row] |= bit(SWDelegate::SW_DURATION) | bit(SWDelegate::SW_BITRATE);
+    }
+
+    if (fileType == ED2KFT_VIDEO)
+    {
+        rows.codec[row] = intern(entry.m_strMediaCodec);
+        rows.columns[row] |= bit(SWDelegate::SW_CODEC);
+    }
+}
+
+const SearchResultModel::Rows& SearchResultModel::rowsOf(const QModelIndex& index) const
+{
+    if (index.internalId() == 0) return m_rows;
+    return m_children.at(int(index.internalId() - 1));
+}
+
+QVariant SearchResultModel::value(const Rows& rows, int row, int column) const
+{
+    if (!(rows.columns.at(row) & bit(column)))
+        return QVariant();
+
+    switch (column)
+    {
+        case SWDelegate::SW_NAME:           return m_pool.at(rows.name.at(row));
+        case SWDelegate::SW_SIZE:           return qulonglong(rows.size.at(row));
+        case SWDelegate::SW_AVAILABILITY:   return qulonglong(rows.availability.at(row));
+        case SWDelegate::SW_SOURCES:        return qulonglong(rows.sources.at(row));
+        case SWDelegate::SW_TYPE:           return typeName(rows.type.at(row));
+        case SWDelegate::SW_ID:             return rows.hash.at(row);
+        case SWDelegate::SW_DURATION:       return qulonglong(rows.duration.at(row));
+        case SWDelegate::SW_BITRATE:        return qulonglong(rows.bitrate.at(row));
+        case SWDelegate::SW_CODEC:          return m_pool.at(rows.codec.at(row));
+        default:
+            break;
+    }
+
+    return QVariant();
+}
+
+QString SearchResultModel::typeName(int type)
+{
+    // translations are kept in context of search widget
+    switch (type)
+    {
+        case ED2KFT_AUDIO:              return QCoreApplication::translate("search_widget", "Audio");
+        case ED2KFT_VIDEO:              return QCoreApplication::translate("search_widget", "Video");
+        case ED2KFT_IMAGE:              return QCoreApplication::translate("search_widget", "Picture");
+        case ED2KFT_PROGRAM:            return QCoreApplication::translate("search_widget", "Program");
+        case ED2KFT_DOCUMENT:           return QCoreApplication::translate("search_widget", "Document");
+        case ED2KFT_ARCHIVE:            return QCoreApplication::translate("search_widget", "Archive");
+        case ED2KFT_CDIMAGE:            return QCoreApplication::translate("search_widget", "CD Image");
+        case ED2KFT_EMULECOLLECTION:    return QCoreApplication::translate("search_widget", "Emule Collection");
+        default:
+            break;
+    }
+
+    return QString();
+}
@@ -0,0 +1,137 @@
+#ifndef SEARCH_RESULT_MODEL_H
+#define SEARCH_RESULT_MODEL_H
+
+#include <vector>
+#include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
+#include <QString>
+#include <QVector>
+
+#include "search_widget_delegate.h"
+#include "qtlibed2k/qed2ksession.h"
+
+/**
+  * search results of current tab, two levels: top rows and files of folder rows
+  * values are kept column by column, file names and codecs are interned in one pool
+ */
+class SearchResultModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum IconKind
+    {
+        IK_NONE,
+        IK_ANY,
+        IK_AUDIO,
+        IK_VIDEO,
+        IK_PICTURE,
+        IK_PROGRAM,
+        IK_DOCUMENT,
+        IK_ARCHIVE,
+        IK_CDIMAGE,
+        IK_COLLECTION,
+        IK_FOLDER,
+        IK_USER,
+        IK_USER_CONNECTED,
+        IK_NUM
+    };
+
+    SearchResultModel(QObject* parent = 0);
+
+    void setIcon(IconKind kind, const QIcon& icon);
+
+    /**
+      * rows are added between beginFill and endFill, views see one reset
+     */
+    void beginFill();
+    void endFill();
+    /**
+      * rows added between beginAppend and endAppend go after existing rows as one inserted range
+     */
+    void beginAppend(int count);
+    void endAppend();
+
+    void addFile(const QED2KSearchResultEntry& entry);
+    void addClient(const QED2KSearchResultEntry& entry, bool connected);
+    /**
+      * folder row, negative size or availability leaves column empty
+     */
+    int addFolder(const QString& path, qint64 size, qint64 availability, const QString& hash);
+    /**
+      * files of folder row, files count becomes folder availability
+     */
+    void setFolderFiles(int row, const std::vector<QED2KSearchResultEntry>& files);
+    /**
+      * one empty child row makes folder expandable before its files come
+     */
+    void addPlaceholder(int row);
+    void removeChildren(int row);
+
+    /**
+      * new sources of file row, repeated search result was merged into it
+     */
+    void setSources(int row, quint64 availability, quint64 sources);
+    void setClientConnected(const QString& hash, bool connected);
+    /**
+      * transfer with hash was added or deleted, rows with this hash are changed
+     */
+    void transferChanged(const QString& hash);
+    /**
+      * top row which has string value in column, -1 when not found
+     */
+    int findRow(SWDelegate::Column column, const QString& value) const;
+
+    bool isTorrentLink(const QModelIndex& index) const;
+    /**
+      * compares typed values of index column, strings are compared case insensitive
+     */
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const;
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex& index) const;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+    bool setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role = Qt::EditRole);
+
+private:
+    enum { FLAG_TORRENT = 1 };
+
+    struct Rows
+    {
+        QVector<int>        name;       // pool ids
+        QVector<quint64>    size;
+        QVector<quint64>    availability;
+        QVector<quint64>    sources;
+        QVector<qint8>      type;       // EED2KFileType, -1 for none
+        QVector<QString>    hash;
+        QVector<quint64>    duration;
+        QVector<quint64>    bitrate;
+        QVector<int>        codec;      // pool ids
+        QVector<quint8>     icon;
+        QVector<quint8>     flags;
+        QVector<quint16>    columns;    // bit per column which has value
+
+        int count() const { return name.size(); }
+        void append();
+        void clear();
+    };
+
+    int intern(const QString& str);
+    void appendFile(Rows& rows, const QED2KSearchResultEntry& entry);
+    const Rows& rowsOf(const QModelIndex& index) const;
+    QVariant value(const Rows& rows, int row, int column) const;
+    static QString typeName(int type);
+
+    Rows                    m_rows;
+    QVector<Rows>           m_children;     // per top row
+    QVector<QString>        m_pool;
+    QHash<QString, int>     m_poolIds;
+    QVector<QIcon>          m_icons;
+    QVector<QString>        m_headers;
+    bool                    m_filling;  // reset or append is in progress, no row signals
+};
+
+#endif // SEARCH_RESULT_MODEL_H
@@ -2,13 +2,12 @@
 #include <QAction>
 #include <QPushButton>
 #include <QMouseEvent>
-#include <QStandardItemModel>
 #include <QMessageBox>
-#include <QWebFrame>
-#include <QWebElementCollection>
+#include <QTextDocument>
 
 #include "collection_save_dlg.h"
 #include "search_widget.h"
+#include "search_result_model.h"
 #include "search_filter.h"
 #include "preferences.h"
 #include "user_properties.h"
@@ -36,7 +35,7 @@ boost::optional<qulonglong> toULongLong(const QString& str)
 
 bool inSession(const QString& hash)
 {
-    return misc::isMD4Hash(hash) && Session::instance()->getTransfer(hash).is_valid();
+    return Session::instance()->hasTransfer(hash) || Session::instance()->sharedNames().contains(hash);
 }
 
 QColor itemColor(const QModelIndex& inx)
@@ -108,6 +107,46 @@ SearchResult::SearchResult(Preferences& pref)
 
     netPoint.m_nIP  = pref.value("IP", 0).toUInt();
     netPoint.m_nPort= pref.value("Port", 0).toUInt();
+
+    indexFiles();
+}
+
+void SearchResult::indexFiles()
+{
+    fileRows.clear();
+    if (resultType != RT_FILES) return;
+
+    for (size_t pos = 0; pos < vecResults.size(); ++pos)
+    {
+        const QString& hash = vecResults[pos].m_hFile;
+        // torrent links have site name instead of hash
+        if (misc::isMD4Hash(hash) && !fileRows.contains(hash))
+            fileRows.insert(hash, pos);
+    }
+}
+
+int SearchResult::mergeFile(const QED2KSearchResultEntry& entry)
+{
+    if (resultType == RT_FILES && misc::isMD4Hash(entry.m_hFile))
+    {
+        QHash<QString, int>::const_iterator itr = fileRows.constFind(entry.m_hFile);
+
+        if (itr != fileRows.constEnd())
+        {
+            QED2KSearchResultEntry& file = vecResults[itr.value()];
+            if (entry.m_nSources <= file.m_nSources && entry.m_nCompleteSources <= file.m_nCompleteSources)
+                return -1;
+
+            file.m_nSources = qMax(file.m_nSources, entry.m_nSources);
+            file.m_nCompleteSources = qMax(file.m_nCompleteSources, entry.m_nCompleteSources);
+            return itr.value();
+        }
+
+        fileRows.insert(entry.m_hFile, vecResults.size());
+    }
+
+    vecResults.push_back(entry);
+    return -1;
 }
 
 void SearchResult::save(Preferences& pref) const
@@ -278,7 +317,19 @@ search_widget::search_widget(QWidget *parent)
 
     checkOwn->setChecked(Qt::Checked);
 
-    model.reset(new SWItemModel(0, SWDelegate::SW_COLUMNS_NUM));
+    model.reset(new SearchResultModel());
+    model.data()->setIcon(SearchResultModel::IK_ANY, iconAny);
+    model.data()->setIcon(SearchResultModel::IK_AUDIO, iconAudio);
+    model.data()->setIcon(SearchResultModel::IK_VIDEO, iconVideo);
+    model.data()->setIcon(SearchResultModel::IK_PICTURE, iconPicture);
+    model.data()->setIcon(SearchResultModel::IK_PROGRAM, iconProgram);
+    model.data()->setIcon(SearchResultModel::IK_DOCUMENT, iconDocument);
+    model.data()->setIcon(SearchResultModel::IK_ARCHIVE, iconArchive);
+    model.data()->setIcon(SearchResultModel::IK_CDIMAGE, iconCDImage);
+    model.data()->setIcon(SearchResultModel::IK_COLLECTION, iconCollection);
+    model.data()->setIcon(SearchResultModel::IK_FOLDER, iconFolder);
+    model.data()->setIcon(SearchResultModel::IK_USER, QIcon(":/emule/common/client_red.ico"));
+    model.data()->setIcon(SearchResultModel::IK_USER_CONNECTED, QIcon(":/emule/common/User.ico"));
     model.data()->setHeaderData(SWDelegate::SW_NAME, Qt::Horizontal,           tr("File Name"));
     model.data()->setHeaderData(SWDelegate::SW_SIZE, Qt::Horizontal,           tr("File Size"));
     model.data()->setHeaderData(SWDelegate::SW_AVAILABILITY, Qt::Horizontal,   tr("Availability"));
@@ -301,17 +352,17 @@ search_widget::search_widget(QWidget *parent)
     itemDelegate = new SWDelegate(treeResult);
     treeResult->setItemDelegate(itemDelegate);
 
-    //searchFilter = new search_filter(this);
-    //searchFilter->setMinimumSize(QSize(180, 20));
-    //searchFilter->setMaximumSize(QSize(180, 16777215));
+    searchFilter = new search_filter(this);
+    searchFilter->setMinimumSize(QSize(180, 20));
+    searchFilter->setMaximumSize(QSize(180, 16777215));
     QSizePolicy sizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     sizePolicy.setHorizontalStretch(0);
     sizePolicy.setVerticalStretch(0);
-    //sizePolicy.setHeightForWidth(searchFilter->sizePolicy().hasHeightForWidth());
-    //searchFilter->setSizePolicy(sizePolicy);
+    sizePolicy.setHeightForWidth(searchFilter->sizePolicy().hasHeightForWidth());
+    searchFilter->setSizePolicy(sizePolicy);
 
-    //searchFilter->hide();
-    //horizontalLayoutTabs->addWidget(searchFilter);
+    searchFilter->hide();
+    horizontalLayoutTabs->addWidget(searchFilter);
 
     connect(tableCond, SIGNAL(itemClicked(QTableWidgetItem*)), this, SLOT(itemCondClicked(QTableWidgetItem*)));
     connect(btnStart, SIGNAL(clicked()), this, SLOT(startSearch()));
@@ -321,13 +372,17 @@ search_widget::search_widget(QWidget *parent)
     connect(checkOwn, SIGNAL(stateChanged(int)), this, SLOT(showOwn(int)));
     connect(Session::instance()->get_ed2k_session(),
             SIGNAL(searchResult(const libed2k::net_identifier&, const QString&,
-                                const std::vector<QED2KSearchResultEntry>&, bool)),
+                                const QED2KSearchResultBatch&, bool)),
     		this, SLOT(ed2kSearchFinished(const libed2k::net_identifier&, const QString&,
-                                          const std::vector<QED2KSearchResultEntry>&, bool)));
+                                          const QED2KSearchResultBatch&, bool)));
     connect(Session::instance(), SIGNAL(addedTransfer(Transfer)),
             this, SLOT(addedTransfer(Transfer)));
     connect(Session::instance(), SIGNAL(deletedTransfer(QString)),
             this, SLOT(deletedTransfer(const QString&)));
+    connect(Session::instance(), SIGNAL(insertSharedFile(FileNode*)),
+            this, SLOT(sharedFileChanged(FileNode*)));
+    connect(Session::instance(), SIGNAL(removeSharedFile(FileNode*)),
+            this, SLOT(sharedFileChanged(FileNode*)));
     connect(tabSearch, SIGNAL(tabCloseRequested(int)), this, SLOT(closeTab(int)));
     connect(tabSearch, SIGNAL(currentChanged (int)), this, SLOT(selectTab(int)));
     connect(closeAll, SIGNAL(triggered()),  this, SLOT(closeAllTabs()));
@@ -336,16 +391,16 @@ search_widget::search_widget(QWidget *parent)
     connect(defMegas,  SIGNAL(triggered()), this, SLOT(setSizeType()));
     connect(comboName,  SIGNAL(editTextChanged(const QString)), this, SLOT(searchTextChanged(const QString)));
     connect(comboName->lineEdit(), SIGNAL(returnPressed()), this, SLOT(startSearch()));
-    //connect(searchFilter, SIGNAL(textChanged(QString)), this, SLOT(applyFilter(QString)));
-    //connect(searchFilter, SIGNAL(filterSelected(SWDelegate::Column)), this, SLOT(setFilterType(SWDelegate::Column)));
+    connect(searchFilter, SIGNAL(textChanged(QString)), this, SLOT(applyFilter(QString)));
+    connect(searchFilter, SIGNAL(filterSelected(SWDelegate::Column)), this, SLOT(setFilterType(SWDelegate::Column)));
     connect(Session::instance()->get_ed2k_session(), SIGNAL(peerSharedDirectories(const libed2k::net_identifier&, const QString&, const QStringList&)),
             this, SLOT(processUserDirs(const libed2k::net_identifier&, const QString&, const QStringList&)));
     connect(Session::instance()->get_ed2k_session(),
-            SIGNAL(peerSharedDirectoryFiles(const libed2k::net_identifier&, const QString&, const QString&, const std::vector<QED2KSearchResultEntry>&)),
-            this, SLOT(processUserFiles(const libed2k::net_identifier&, const QString&, const QString&, const std::vector<QED2KSearchResultEntry>&)));
+            SIGNAL(peerSharedDirectoryFiles(const libed2k::net_identifier&, const QString&, const QString&, const QED2KSearchResultBatch&)),
+            this, SLOT(processUserFiles(const libed2k::net_identifier&, const QString&, const QString&, const QED2KSearchResultBatch&)));
     connect(Session::instance()->get_ed2k_session(),
-            SIGNAL(peerIsModSharedFiles(const libed2k::net_identifier&, const QString&, const QString&, const std::vector<QED2KSearchResultEntry>&)),
-            this, SLOT(processIsModSharedFiles(const libed2k::net_identifier&, const QString&, const QString&, const std::vector<QED2KSearchResultEntry>&)));
+            SIGNAL(peerIsModSharedFiles(const libed2k::net_identifier&, const QString&, const QString&, const QED2KSearchResultBatch&)),
+            this, SLOT(processIsModSharedFiles(const libed2k::net_identifier&, const QString&, const QString&, const QED2KSearchResultBatch&)));
 
     userMenu = new QMenu(this);
     userMenu->setObjectName(QString::fromUtf8("userMenu"));
@@ -462,9 +517,9 @@ search_widget::search_widget(QWidget *parent)
             this, SLOT(displayHSMenu(const QPoint&)));
     connect(treeResult, SIGNAL(doubleClicked(const QModelIndex&)), this, SLOT(download()));
 
-    torrentSearchView = new QWebView();
-    connect(torrentSearchView, SIGNAL(loadFinished(bool)),
-            this, SLOT(torrentSearchFinished(bool)));
+    torrentSearch.reset(new TorrtillaSearch());
+    connect(torrentSearch.data(), SIGNAL(finished(bool, const QList<TorrentSearchRow>&)),
+            this, SLOT(torrentSearchFinished(bool, const QList<TorrentSearchRow>&)));
 
     // sort by name ascending
     treeResult->header()->setSortIndicator(SWDelegate::SW_NAME, Qt::AscendingOrder);
@@ -493,6 +548,7 @@ void search_widget::load()
         pref.setArrayIndex(i);
         QString title = pref.value("Title", QString()).toString();        
         searchItems.push_back(SearchResult(pref));
+        indexFiles(searchItems.size() - 1, 0);
         if (searchItems[searchItems.size() - 1].resultType == RT_USER_DIRS)
             nCurTabSearch = tabSearch->addTab(iconUserFiles, title);
         else
@@ -503,7 +559,7 @@ void search_widget::load()
     {
         tabSearch->setCurrentIndex(nCurTabSearch);
         tabSearch->show();
-        //searchFilter->show();
+        searchFilter->show();
         closeAll->setEnabled(true);
     }
 
@@ -743,9 +799,12 @@ void search_widget::startSearch()
         fileType != ED2KFTSTR_FOLDER.c_str() &&
         fileType != ED2KFTSTR_USER.c_str())
     {
-        torrentSearchView->load(QUrl(QString("http://torrtilla.ru/torrents/0/") + searchRequest));
+        torrentSearch->search(searchRequest);
         nSearchesInProgress++;
     }
+
+    // results stream in by pages, they are sorted when search finishes
+    filterModel->deferSorting(nSearchesInProgress > 0);
 }
 
 void search_widget::continueSearch()
@@ -759,11 +818,13 @@ void search_widget::continueSearch()
     Session::instance()->get_ed2k_session()->searchMoreResults();
 
     nSearchesInProgress += 1;
+    filterModel->deferSorting(true);
 }
 
 void search_widget::cancelSearch()
 {
     Session::instance()->get_ed2k_session()->cancelSearch();
+    torrentSearch->cancel();
 
     btnStart->setDisabled(comboName->currentText().isEmpty());
     btnCancel->setEnabled(false);
@@ -772,6 +833,7 @@ void search_widget::cancelSearch()
     tabSearch->setTabIcon(nCurTabSearch, iconSearchResult);
 
     nSearchesInProgress = 0;
+    filterModel->deferSorting(false);
 
     nCurTabSearch = -1;
 }
@@ -813,6 +875,8 @@ void search_widget::searchRelatedFiles()
         Session::instance()->get_ed2k_session()->searchRelatedFiles(hash);
         nSearchesInProgress = 1;
     }
+
+    filterModel->deferSorting(nSearchesInProgress > 0);
 }
 
 bool typeFilter(const std::string strType, QED2KSearchResultEntry entry)
@@ -835,27 +899,33 @@ void search_widget::processSearchResult(
     if (obMoreResult)
         btnMore->setEnabled(*obMoreResult);
 
-    searchItems[nCurTabSearch].vecResults.insert(searchItems[nCurTabSearch].vecResults.end(), vRes.begin(), vRes.end());
-
-    if (m_lastSearchFileType == QString::fromStdString(libed2k::ED2KFTSTR_CDIMAGE) ||
+    SearchResult& result = searchItems[nCurTabSearch];
+    std::vector<QED2KSearchResultEntry>& vecResults = result.vecResults;
+    const size_t first = vecResults.size();
+    const bool bFilterType =
+        m_lastSearchFileType == QString::fromStdString(libed2k::ED2KFTSTR_CDIMAGE) ||
         m_lastSearchFileType == QString::fromStdString(libed2k::ED2KFTSTR_ARCHIVE) ||
-        m_lastSearchFileType == QString::fromStdString(libed2k::ED2KFTSTR_PROGRAM))
+        m_lastSearchFileType == QString::fromStdString(libed2k::ED2KFTSTR_PROGRAM);
+
+    // files repeated on next pages are merged into rows they already have
+    QList<int> merged;
+    std::vector<QED2KSearchResultEntry>::const_iterator res_it;
+    for (res_it = vRes.begin(); res_it != vRes.end(); ++res_it)
     {
-        searchItems[nCurTabSearch].vecResults.erase(
-            std::remove_if(searchItems[nCurTabSearch].vecResults.begin(),
-                           searchItems[nCurTabSearch].vecResults.end(),
-                           std::bind1st(std::ptr_fun(&typeFilter),
-                                        m_lastSearchFileType.toStdString())),
-            searchItems[nCurTabSearch].vecResults.end());
+        if (bFilterType && typeFilter(m_lastSearchFileType.toStdString(), *res_it))
+            continue;
+
+        int pos = result.mergeFile(*res_it);
+        if (pos >= 0)
+            merged << pos;
     }
 
     quint64 overallSize = 0;
     QString strCaption;
     std::vector<QED2KSearchResultEntry>::iterator it;
-    std::vector<QED2KSearchResultEntry>& vecResults = searchItems[nCurTabSearch].vecResults;
     if (vRes.size() > 0)
     {
-        switch (searchItems[nCurTabSearch].resultType)
+        switch (result.resultType)
         {
             case RT_FILES:
             {
@@ -866,8 +936,8 @@ void search_widget::processSearchResult(
             }
             case RT_FOLDERS:
             {
-                std::vector<UserDir>& userDirs = searchItems[nCurTabSearch].vecUserDirs;
-                for (it = vecResults.begin(); it != vecResults.end(); ++it)
+                std::vector<UserDir>& userDirs = result.vecUserDirs;
+                for (it = vecResults.begin() + first; it != vecResults.end(); ++it)
                 {
                     QString folderName = it->m_strFilename;
                     int nPos = folderName.lastIndexOf("+++");
@@ -898,7 +968,10 @@ void search_widget::processSearchResult(
                     UserDir dir;
                     dir.dirPath = folderName;
                     userDirs.push_back(dir);
-            
+                }
+
+                for (it = vecResults.begin(); it != vecResults.end(); ++it)
+                {
                     quint64 total_size = ((quint64)it->m_nMediaBitrate << 32) + (unsigned int)it->m_nMediaLength;
                     total_size = total_size ? total_size : it->m_nFilesize;
                     overallSize += total_size;
@@ -919,12 +992,33 @@ void search_widget::processSearchResult(
             }
         }
 
-        strCaption += searchItems[nCurTabSearch].strRequest + " (" + QString::number(qulonglong(vecResults.size())) + ") - " + misc::friendlyUnit(overallSize);
+        strCaption += result.strRequest + " (" + QString::number(qulonglong(vecResults.size())) + ") - " + misc::friendlyUnit(overallSize);
         tabSearch->setTabText(nCurTabSearch, strCaption);
     }
 
+    indexFiles(nCurTabSearch, first);
+
     if (tabSearch->currentIndex() == nCurTabSearch)
-        selectTab(nCurTabSearch);
+    {
+        // local filter knows new files before their rows come
+        if (!localFilter.isEmpty())
+            updateLocalFilter();
+
+        // only new rows go to views, rows above stay as they are
+        if (vecResults.size() > first)
+        {
+            QList<int> expanded;
+            model->beginAppend(vecResults.size() - first);
+            appendRows(nCurTabSearch, first, expanded);
+            model->endAppend();
+        }
+
+        foreach (int row, merged)
+            model->setSources(row, vecResults[row].m_nSources, vecResults[row].m_nCompleteSources);
+    }
+
+    if (nSearchesInProgress == 0)
+        filterModel->deferSorting(false);
 }
 
 Transfer search_widget::addTransfer(const QModelIndex& index)
@@ -965,7 +1059,7 @@ void search_widget::prepareNewSearch(
     if (!tabSearch->count())
     {
         tabSearch->show();
-        //searchFilter->show();
+        searchFilter->show();
     }
 
     nCurTabSearch = tabSearch->addTab(icon, reqType + reqText);
@@ -993,16 +1087,21 @@ void search_widget::closeTab(int index)
         btnMore->setEnabled(false);
 
         nSearchesInProgress = 0;
+        filterModel->deferSorting(false);
+        torrentSearch->cancel();
     }
     tabSearch->removeTab(index);
     
     if (searchItems.size() > index)
+    {
+        unindexFiles(index);
         searchItems.erase(searchItems.begin() + index);
+    }
         
     if (!tabSearch->count())
     {
         clearSearchTable();
-        //searchFilter->hide();
+        searchFilter->hide();
         btnCloseAll->setDisabled(true);
     }
     else
@@ -1014,200 +1113,94 @@ void search_widget::selectTab(int nTabNum)
     if (nTabNum >= searchItems.size() || nTabNum < 0)
         return;
 
+    // folders to expand after views got new rows
+    QList<int> expanded;
+
+    model->beginFill();
+
+    RESULT_TYPE resultType = searchItems[nTabNum].resultType;
+    bool bFolders = (resultType == RT_USER_DIRS || resultType == RT_FOLDERS);
+    treeResult->setItemsExpandable(bFolders);
+    treeResult->setRootIsDecorated(bFolders);
+    treeResult->setSelectionMode(resultType == RT_FILES ?
+        QAbstractItemView::ExtendedSelection : QAbstractItemView::SingleSelection);
+
+    appendRows(nTabNum, 0, expanded);
+
+    model->endFill();
+
+    // hash filter of previous tab doesn't fit this one
+    updateLocalFilter();
+
+    foreach (int row, expanded)
+        treeResult->setExpanded(filterModel->mapFromSource(model->index(row, 0)), true);
+}
+
+void search_widget::appendRows(int nTabNum, size_t first, QList<int>& expanded)
+{
     std::vector<QED2KSearchResultEntry> const& vRes = searchItems[nTabNum].vecResults;
     std::vector<QED2KSearchResultEntry>::const_iterator it;
 
-    clearSearchTable();
-    int row = 0;
-
-    treeResult->setItemsExpandable(false);
-    treeResult->setRootIsDecorated(false);
-    treeResult->setSelectionMode(QAbstractItemView::ExtendedSelection);
     if (searchItems[nTabNum].resultType == RT_FILES)
     {
-        for (it = vRes.begin(); it != vRes.end(); ++it)
-        {
-            model->insertRow(row);
-            fillFileValues(row, *it);
-            row++;
-        }
+        for (it = vRes.begin() + first; it != vRes.end(); ++it)
+            model->addFile(*it);
     }
     else if (searchItems[nTabNum].resultType == RT_CLIENTS)
     {
-        treeResult->setSelectionMode(QAbstractItemView::SingleSelection);
-        QIcon user_icon(":/emule/common/client_red.ico");
-        QIcon conn_icon(":/emule/common/User.ico");
-
-        for (it = vRes.begin(); it != vRes.end(); ++it)
+        for (it = vRes.begin() + first; it != vRes.end(); ++it)
         {
-            model->insertRow(row);
-            QString user_name = it->m_strFilename;
-            user_name.replace("+++USERNICK+++", "");
-            // for users size calculated from
-            // m_nMediaLength  - low part of real size
-            // m_nMediaBitrate - high part of real size
-            model->setData(model->index(row, SWDelegate::SW_NAME), user_name.trimmed());
-            quint64 total_size = ((quint64)it->m_nMediaBitrate << 32) + (unsigned int)it->m_nMediaLength;
-            model->setData(model->index(row, SWDelegate::SW_SIZE), total_size);
-            model->setData(model->index(row, SWDelegate::SW_ID), it->m_hFile);
-
-            std::vector<libed2k::net_identifier>::const_iterator con_ip;
-            for (con_ip = connectedPeers.begin(); con_ip != connectedPeers.end(); ++con_ip)
-                if (*con_ip == it->m_network_point)
-                    break;
-
-            if (con_ip == connectedPeers.end())
-                model->item(row)->setIcon(user_icon);
-            else
-                model->item(row)->setIcon(conn_icon);
+            bool connected = std::find(connectedPeers.begin(), connectedPeers.end(), it->m_network_point) !=
+                connectedPeers.end();
+            model->addClient(*it, connected);
         }
     }
     else if (searchItems[nTabNum].resultType == RT_USER_DIRS)
     {
-        treeResult->setSelectionMode(QAbstractItemView::SingleSelection);
-        treeResult->setItemsExpandable(true);
-        treeResult->setRootIsDecorated(true);
         std::vector<UserDir>& userDirs = searchItems[nTabNum].vecUserDirs;
         std::vector<UserDir>::iterator dir_iter;
-        for (dir_iter = userDirs.begin(); dir_iter != userDirs.end(); ++dir_iter)
+        for (dir_iter = userDirs.begin() + first; dir_iter != userDirs.end(); ++dir_iter)
         {
-            model->insertRow(row);
-            model->setData(model->index(row, SWDelegate::SW_NAME), dir_iter->dirPath);
-            model->item(row)->setIcon(iconFolder);
-            QModelIndex index = model->index(row, 0);
+            int row = model->addFolder(dir_iter->dirPath, -1, -1, QString());
 
-            const std::vector<QED2KSearchResultEntry>& files = dir_iter->vecFiles;
-            if (files.size() > 0)
-            {
-                model->setData(model->index(row, SWDelegate::SW_AVAILABILITY),
-                               qulonglong(files.size()));
-                quint64 size = 0;
-                std::vector<QED2KSearchResultEntry>::const_iterator file_iter;
-                for (file_iter = files.begin(); file_iter != files.end(); ++file_iter)
-                    size += file_iter->m_nFilesize;
-                model->setData(model->index(row, SWDelegate::SW_SIZE), size);
+            if (dir_iter->vecFiles.size() > 0)
+                model->setFolderFiles(row, dir_iter->vecFiles);
 
-                model->insertRows(0, files.size(), index);
-                model->insertColumns(0, SWDelegate::SW_COLUMNS_NUM, index);
-            }
-
-            dir_iter->bFilled = false;
+            // files are set with folder
+            dir_iter->bFilled = true;
             if (dir_iter->bExpanded)
-                treeResult->setExpanded(filterModel->mapFromSource(index), true);
-        }        
+                expanded << row;
+        }
     }
     else if (searchItems[nTabNum].resultType == RT_FOLDERS)
     {
-        treeResult->setSelectionMode(QAbstractItemView::SingleSelection);
-        treeResult->setItemsExpandable(true);
-        treeResult->setRootIsDecorated(true);
-
         std::vector<UserDir>& userDirs = searchItems[nTabNum].vecUserDirs;
-        std::vector<UserDir>::iterator dir_iter = userDirs.begin();
-        for (it = vRes.begin(); it != vRes.end(); ++it, ++dir_iter)
+        std::vector<UserDir>::iterator dir_iter = userDirs.begin() + first;
+        for (it = vRes.begin() + first; it != vRes.end(); ++it, ++dir_iter)
         {
-            model->insertRow(row);
-            model->setData(model->index(row, SWDelegate::SW_NAME), dir_iter->dirPath);
-            model->item(row)->setIcon(iconFolder);
-            model->setData(model->index(row, SWDelegate::SW_AVAILABILITY), it->m_nSources);
             quint64 total_size = ((quint64)it->m_nMediaBitrate << 32) + (unsigned int)it->m_nMediaLength;
             total_size = total_size ? total_size : it->m_nFilesize;
-            model->setData(model->index(row, SWDelegate::SW_SIZE), total_size);
-            model->setData(model->index(row, SWDelegate::SW_ID), it->m_hFile);
+            int row = model->addFolder(dir_iter->dirPath, total_size, it->m_nSources, it->m_hFile);
 
-            QModelIndex index = model->index(row, 0);
             if (!dir_iter->bFilled)
             {
                 if (!dir_iter->bExpanded)
-                {
-                    model->insertRows(0, 1, index);
-                    model->insertColumns(0, 9, index);
-                }
+                    model->addPlaceholder(row);
             }
             else
             {
-                int sub_row = 0;
-                std::vector<QED2KSearchResultEntry>::const_iterator file_iter;
-                model->insertRows(0, dir_iter->vecFiles.size(), index);
-                model->insertColumns(0, SWDelegate::SW_COLUMNS_NUM, index);
-                for (file_iter = dir_iter->vecFiles.begin(); file_iter != dir_iter->vecFiles.end(); ++file_iter)
-                {
-                    fillFileValues(sub_row, *file_iter, index);
-                    sub_row++;
-                }
-
+                model->setFolderFiles(row, dir_iter->vecFiles);
                 if (dir_iter->bExpanded)
-                    treeResult->setExpanded(filterModel->mapFromSource(index), true);
+                    expanded << row;
             }
         }
     }
-
-    QHeaderView* header = treeResult->header();
-    model->sort(header->sortIndicatorSection(), header->sortIndicatorOrder());
-}
-
-void search_widget::fillFileValues(int row, const QED2KSearchResultEntry& fileEntry, const QModelIndex& parent)
-{
-    model->setData(model->index(row, SWDelegate::SW_NAME, parent), fileEntry.m_strFilename);
-    model->setData(model->index(row, SWDelegate::SW_SIZE, parent), fileEntry.m_nFilesize);
-    model->setData(model->index(row, SWDelegate::SW_SOURCES, parent), fileEntry.m_nCompleteSources);
-    model->setData(model->index(row, SWDelegate::SW_AVAILABILITY, parent), fileEntry.m_nSources);
-
-    EED2KFileType fileType = GetED2KFileTypeID(fileEntry.m_strFilename.toStdString());
-    switch (fileType)
-    {
-        case ED2KFT_AUDIO:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Audio"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconAudio);
-            break;
-        case ED2KFT_VIDEO:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Video"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconVideo);
-            break;
-        case ED2KFT_IMAGE:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Picture"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconPicture);
-            break;
-        case ED2KFT_PROGRAM:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Program"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconProgram);
-            break;
-        case ED2KFT_DOCUMENT:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Document"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconDocument);
-            break;
-        case ED2KFT_ARCHIVE:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Archive"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconArchive);
-            break;
-        case ED2KFT_CDIMAGE:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("CD Image"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconCDImage);
-            break;
-        case ED2KFT_EMULECOLLECTION:
-            model->setData(model->index(row, SWDelegate::SW_TYPE, parent), tr("Emule Collection"));
-            model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconCollection);
-            break;
-        default:
-            // don't set icon for torrent links
-            if (!misc::isTorrentLink(fileEntry.m_strFilename))
-                model->itemFromIndex(model->index(row, 0, parent))->setIcon(iconAny);
-
-    }
-    model->setData(model->index(row, SWDelegate::SW_ID, parent), fileEntry.m_hFile);
-    if (fileType == ED2KFT_AUDIO || fileType == ED2KFT_VIDEO)
-    {
-        model->setData(model->index(row, SWDelegate::SW_DURATION, parent), fileEntry.m_nMediaLength);
-        model->setData(model->index(row, SWDelegate::SW_BITRATE, parent), fileEntry.m_nMediaBitrate);
-    }
-    if (fileType == ED2KFT_VIDEO)
-        model->setData(model->index(row, SWDelegate::SW_CODEC, parent), fileEntry.m_strMediaCodec);
 }
 
 void search_widget::clearSearchTable()
 {
-    for (int ii = model->rowCount()-1; ii >= 0; --ii)
-        model->removeRow(ii);
+    model->beginFill();
+    model->endFill();
 }
 
 void search_widget::closeAllTabs()
@@ -1219,6 +1212,7 @@ void search_widget::closeAllTabs()
     }
 
     searchItems.clear();
+    resultNames.clear();
     clearSearchTable();
 }
 
@@ -1271,17 +1265,63 @@ void search_widget::searchTextChanged(const QString text)
 {
     if (!nSearchesInProgress)
         btnStart->setEnabled(text.length() > 0);
+
+    // own files are found without server
+    int shared = Session::instance()->findSharedFiles(text).size();
+    comboName->setToolTip(shared ? tr("%n shared file(s) match", "", shared) : QString());
 }
 
 void search_widget::applyFilter(QString filter)
 {
-    //if (searchFilter->isFilterSet())
-    //    filterModel->setFilterRegExp(QRegExp(filter, Qt::CaseInsensitive));
+    // filter shows column name while it is empty
+    localFilter = searchFilter->isFilterSet() ? filter.trimmed() : QString();
+    updateLocalFilter();
+}
+
+void search_widget::updateLocalFilter()
+{
+    int nTabNum = tabSearch->currentIndex();
+    bool byIndex = filterModel->filterKeyColumn() == SWDelegate::SW_NAME &&
+        nTabNum >= 0 && nTabNum < searchItems.size() && searchItems[nTabNum].resultType == RT_FILES;
+
+    // names are looked up in index of all tabs, rows of current tab are checked by hash only
+    if (!localFilter.isEmpty() && byIndex)
+        filterModel->setHashFilter(resultNames.match(localFilter), true);
+    else
+        filterModel->setHashFilter(QSet<QString>(), false);
+
+    // other columns and result types are matched by text
+    QRegExp rx((localFilter.isEmpty() || byIndex) ? QString() : QRegExp::escape(localFilter), Qt::CaseInsensitive);
+    if (filterModel->filterRegExp() != rx)
+        filterModel->setFilterRegExp(rx);
+}
+
+void search_widget::indexFiles(int nTabNum, size_t first)
+{
+    const SearchResult& result = searchItems[nTabNum];
+    if (result.resultType != RT_FILES) return;
+
+    // every tab refers each hash once, position of file is its first entry
+    for (size_t pos = first; pos < result.vecResults.size(); ++pos)
+    {
+        const QED2KSearchResultEntry& entry = result.vecResults[pos];
+        if (result.fileRows.value(entry.m_hFile, -1) == int(pos))
+            resultNames.add(entry.m_hFile, entry.m_strFilename);
+    }
+}
+
+void search_widget::unindexFiles(int nTabNum)
+{
+    if (searchItems[nTabNum].resultType != RT_FILES) return;
+
+    foreach(const QString& hash, searchItems[nTabNum].fileRows.keys())
+        resultNames.remove(hash);
 }
 
 void search_widget::setFilterType(SWDelegate::Column column)
 {
     filterModel->setFilterKeyColumn(column);
+    updateLocalFilter();
 }
 
 void search_widget::displayListMenu(const QPoint&) 
@@ -1363,15 +1403,13 @@ void search_widget::addToFriends()
 void search_widget::peerConnected(const libed2k::net_identifier& np, const QString& hash, bool bActive)
 {
     connectedPeers.push_back(np);
-    QIcon conn_icon(":/emule/common/User.ico");
-    setUserPicture(np, conn_icon);
+    setUserPicture(np, true);
 }
 
 void search_widget::peerDisconnected(const libed2k::net_identifier& np, const QString& hash, const libed2k::error_code ec)
 {
 	connectedPeers.erase(std::remove(connectedPeers.begin(), connectedPeers.end(), np), connectedPeers.end());
-    QIcon user_icon(":/emule/common/client_red.ico");
-    setUserPicture(np, user_icon);
+    setUserPicture(np, false);
 }
 
 void search_widget::resultSelectionChanged(const QItemSelection& sel, const QItemSelection& unsel)
@@ -1527,8 +1565,7 @@ bool search_widget::hasSelectedFiles()
     {
         if (selected.first().parent() == treeResult->rootIndex())
         {
-            QString hash = model->data(
-                model->index(selected.first().row(), SWDelegate::SW_ID)).toString();
+            QString hash = selected_data(treeResult, SWDelegate::SW_ID, selected.first()).toString();
 
             std::vector<QED2KSearchResultEntry> const& vRes =
                 searchItems[tabSearch->currentIndex()].vecResults;
@@ -1567,7 +1604,7 @@ void search_widget::updateFileActions()
     filePreview->setEnabled(hasSelectedMedia());
 }
 
-void search_widget::setUserPicture(const libed2k::net_identifier& np, QIcon& icon)
+void search_widget::setUserPicture(const libed2k::net_identifier& np, bool connected)
 {
     if (tabSearch->currentIndex() < 0)
         return;
@@ -1582,12 +1619,7 @@ void search_widget::setUserPicture(const libed2k::net_identifier& np, QIcon& ico
         {
             if (it->m_network_point == np)
             {
-                for (int row = 0; row < model->rowCount(); row++)
-                    if (it->m_hFile == model->data(model->index(row, SWDelegate::SW_ID)).toString())
-                    {
-                        model->item(row)->setIcon(icon);
-                        return;
-                    }
+                model->setClientConnected(it->m_hFile, connected);
                 return;
             }
         }
@@ -1634,7 +1666,7 @@ void search_widget::processUserDirs(
     if (!tabSearch->count())
     {
         tabSearch->show();
-        //searchFilter->show();
+        searchFilter->show();
     }
 
     std::vector<QED2KSearchResultEntry> vec;
@@ -1666,8 +1698,9 @@ void search_widget::processUserDirs(
 
 void search_widget::processUserFiles(
     const libed2k::net_identifier& np, const QString& hash,
-    const QString& strDirectory, const std::vector<QED2KSearchResultEntry>& vRes)
+    const QString& strDirectory, const QED2KSearchResultBatch& batch)
 {
+    const std::vector<QED2KSearchResultEntry>& vRes = *batch;
     int nTabCnt = searchItems.size();
     int nTabNum = nTabCnt - 1;
     
@@ -1700,25 +1733,11 @@ void search_widget::processUserFiles(
     QString strCaption = tr("Files: ") + searchItems[nTabNum].strRequest + " (" + QString::number(totalQnty) + ") - " + misc::friendlyUnit(overallSize);
     tabSearch->setTabText(nTabNum, strCaption);
 
-    if (tabSearch->currentIndex() == nTabNum)
+    if (tabSearch->currentIndex() == nTabNum && iter != userDirs.end() && iter->vecFiles.size() > 0)
     {
-        for (int row = 0; row < model->rowCount(); row++)
-            if (strDirectory == model->data(model->index(row, SWDelegate::SW_NAME)).toString()&&
-                iter->vecFiles.size() > 0)
-            {
-                model->setData(model->index(row, SWDelegate::SW_AVAILABILITY),
-                               qulonglong(iter->vecFiles.size()));
-                quint64 size = 0;
-                std::vector<QED2KSearchResultEntry>::const_iterator file_iter;
-                for (file_iter = iter->vecFiles.begin(); file_iter != iter->vecFiles.end(); ++file_iter)
-                    size += file_iter->m_nFilesize;
-                model->setData(model->index(row, SWDelegate::SW_SIZE), size);
-
-                QModelIndex index = model->index(row, 0);
-                model->insertRows(0, iter->vecFiles.size(), index);
-                model->insertColumns(0, 9, index);
-                break;
-            }
+        int row = model->findRow(SWDelegate::SW_NAME, strDirectory);
+        if (row >= 0)
+            model->setFolderFiles(row, iter->vecFiles);
     }
 }
 
@@ -1740,7 +1759,7 @@ void search_widget::itemCollapsed(const QModelIndex& index)
     }
     if (searchItems[tabSearch->currentIndex()].resultType == RT_FOLDERS)
     {
-        QString hash = model->data(model->index(index.row(), SWDelegate::SW_ID)).toString();
+        QString hash = selected_data(treeResult, SWDelegate::SW_ID, index).toString();
 
         std::vector<UserDir>& userDirs = searchItems[tabSearch->currentIndex()].vecUserDirs;
         std::vector<QED2KSearchResultEntry> const& vRes =
@@ -1771,18 +1790,6 @@ void search_widget::itemExpanded(const QModelIndex& index)
             if(iter->dirPath == dirName && iter->vecFiles.size() > 0)
             {
                 iter->bExpanded = true;
-                if (!iter->bFilled)
-                {
-                    QModelIndex real_index = filterModel->mapToSource(index);
-                    std::vector<QED2KSearchResultEntry>::const_iterator file_iter;
-                    int sub_row = 0;
-                    for (file_iter = iter->vecFiles.begin(); file_iter != iter->vecFiles.end(); ++file_iter)
-                    {
-                        fillFileValues(sub_row, *file_iter, real_index);
-                        sub_row++;
-                    }
-                    iter->bFilled = true;
-                }
                 break;
             }
         }
@@ -1790,7 +1797,7 @@ void search_widget::itemExpanded(const QModelIndex& index)
     else if (searchItems[tabSearch->currentIndex()].resultType == RT_FOLDERS)
     {
         QModelIndex real_index = filterModel->mapToSource(index);
-        QString hash = model->data(model->index(real_index.row(), SWDelegate::SW_ID)).toString();
+        QString hash = selected_data(treeResult, SWDelegate::SW_ID, index).toString();
 
         std::vector<QED2KSearchResultEntry> const& vRes =
             searchItems[tabSearch->currentIndex()].vecResults;
@@ -1807,7 +1814,7 @@ void search_widget::itemExpanded(const QModelIndex& index)
         {
             if (!dir_iter->bFilled)
             {
-                model->item(real_index.row())->removeRows(0, 1);
+                model->removeChildren(real_index.row());
                 QED2KPeerHandle::getPeerHandle(it->m_network_point).requestDirFiles(hash);                
             }
             dir_iter->bExpanded = true;
@@ -1843,8 +1850,10 @@ void search_widget::displayHSMenu(const QPoint&)
 
 void search_widget::processIsModSharedFiles(
     const libed2k::net_identifier& np, const QString& hash, const QString& dir_hash,
-    const std::vector<QED2KSearchResultEntry>& vRes)
+    const QED2KSearchResultBatch& batch)
 {
+    const std::vector<QED2KSearchResultEntry>& vRes = *batch;
+
     for (int ii = 0; ii < searchItems.size(); ii++)
     {
         if (searchItems[ii].resultType == RT_FOLDERS)
@@ -1861,62 +1870,23 @@ void search_widget::processIsModSharedFiles(
                         dir_iter->vecFiles.insert(dir_iter->vecFiles.end(), vRes.begin(), vRes.end());
                     dir_iter->bFilled = true;
 
+                    // folders rows go in order of results, only this folder gets its files
                     if (tabSearch->currentIndex() == ii)
-                    {
-                        selectTab(ii);
-                        /*for (int row = 0; row < model->rowCount(); row++)
-                            if (dir_hash == model->data(model->index(row, SWDelegate::SW_ID)).toString())
-                            {
-                                if (!dir_iter->bExpanded && !dir_iter->bFilled)
-                                    model->item(row)->removeRows(0, 1);
-
-                                int sub_row = 0;
-                                std::vector<QED2KSearchResultEntry>::const_iterator file_iter;
-                                QModelIndex parent = model->index(row, 0);
-                                model->insertRows(0, dir_iter->vecFiles.size(), parent);
-                                model->insertColumns(0, SWDelegate::SW_COLUMNS_NUM, parent);
-                                for (file_iter = dir_iter->vecFiles.begin(); file_iter != dir_iter->vecFiles.end(); ++file_iter)
-                                {
-                                    fillFileValues(sub_row, *file_iter, parent);
-                                    sub_row++;
-                                }
-                            }*/
-                    }                    
+                        model->setFolderFiles(it - vecResults.begin(), dir_iter->vecFiles);
                 }
             }
         }
     }
 }
 
-// parse strings like: '500 MB', '1.6 GB'
-// return 0 on fail
-qulonglong parseSize(const QString& strSize)
-{
-    QStringList lst = strSize.split(" ", QString::SkipEmptyParts);
-    float base = 0;
-    qulonglong mes = 1;
-
-    if (lst.size() == 2)
-    {
-        base = lst[0].toFloat();
-
-        if (lst[1] == "KB") mes = 1000;
-        else if (lst[1] == "MB") mes = 1000 * 1000;
-        else if (lst[1] == "GB") mes = 1000 * 1000 * 1000;
-        else mes = 0;
-    }
-
-    return base * mes;
-}
-
 void search_widget::ed2kSearchFinished(
     const libed2k::net_identifier& np,const QString& hash,
-    const std::vector<QED2KSearchResultEntry>& vRes, bool bMoreResult)
+    const QED2KSearchResultBatch& batch, bool bMoreResult)
 {
-    processSearchResult(vRes, bMoreResult);
+    processSearchResult(*batch, bMoreResult);
 }
 
-void search_widget::torrentSearchFinished(bool ok)
+void search_widget::torrentSearchFinished(bool ok, const QList<TorrentSearchRow>& rows)
 {
     std::vector<QED2KSearchResultEntry> entries;
 
@@ -1928,32 +1898,20 @@ void search_widget::torrentSearchFinished(bool ok)
         boost::optional<int> oAvail = toInt(tableCond->item(2, 1)->text());
         boost::optional<int> oSources = toInt(tableCond->item(3, 1)->text());
 
-        QWebElementCollection res_rows =
-            torrentSearchView->page()->mainFrame()->findAllElements("table#res_table tbody tr");
-
-        foreach (QWebElement res, res_rows) {
-            QWebElement eText = res.findFirst("div[class=\"text\"] a");
-            QString name = eText.toPlainText();
-            QString href = eText.attribute("href");
-            QString magnet = res.findFirst("div[class=\"magnet\"] a").attribute("href");
-            QString type = res.findFirst("div[class=\"date\"]").toPlainText();
-            qulonglong size = parseSize(res.findFirst("div[class=\" col-3\"]").toPlainText());
-            int seeders = res.findFirst("div[class=\" col-4\"]").toPlainText().toInt();
-            int leechers = res.findFirst("div[class=\" col-5\"]").toPlainText().toInt();
-            QString site = res.findFirst("div[class=\" col-6\"] span").attribute("title");
-
-            if (!eText.isNull() && size &&
-                size >= oMinSize.get_value_or(0) &&
-                size <= oMaxSize.get_value_or(std::numeric_limits<qulonglong>::max()) &&
-                seeders >= oAvail.get_value_or(0) && seeders >= oSources.get_value_or(0))
+        foreach (const TorrentSearchRow& res, rows) {
+            if (res.m_size &&
+                res.m_size >= oMinSize.get_value_or(0) &&
+                res.m_size <= oMaxSize.get_value_or(std::numeric_limits<qulonglong>::max()) &&
+                res.m_seeders >= oAvail.get_value_or(0) && res.m_seeders >= oSources.get_value_or(0))
             {
                 QED2KSearchResultEntry entry;
-                entry.m_strFilename = eText.toOuterXml();
-                entry.m_nFilesize = size;
-                entry.m_nSources = seeders;
-                entry.m_nCompleteSources = seeders;
-                entry.m_strMediaCodec = type;
-                entry.m_hFile = site;
+                // name column shows link to torrent page
+                entry.m_strFilename = "<a href=\"" + Qt::escape(res.m_url) + "\">" + Qt::escape(res.m_name) + "</a>";
+                entry.m_nFilesize = res.m_size;
+                entry.m_nSources = res.m_seeders;
+                entry.m_nCompleteSources = res.m_seeders;
+                entry.m_strMediaCodec = res.m_type;
+                entry.m_hFile = res.m_site;
                 entries.push_back(entry);
             }
         }
@@ -1969,13 +1927,24 @@ void search_widget::torrentSearchFinished(bool ok)
 void search_widget::addedTransfer(Transfer t)
 {
     updateFileActions();
-    filterModel->showOwn(checkOwn->isChecked());
+    // proxy filters changed rows again by itself
+    model->transferChanged(t.hash());
 }
 
 void search_widget::deletedTransfer(const QString& hash)
 {
     updateFileActions();
-    filterModel->showOwn(checkOwn->isChecked());
+    model->transferChanged(hash);
+}
+
+void search_widget::sharedFileChanged(FileNode* node)
+{
+    // shared files are own files too, rows of files tab are scanned only for found files
+    int nTabNum = tabSearch->currentIndex();
+    bool indexed = nTabNum >= 0 && nTabNum < searchItems.size() && searchItems[nTabNum].resultType == RT_FILES;
+
+    if (!indexed || resultNames.contains(node->hash()))
+        model->transferChanged(node->hash());
 }
 
 void search_widget::getUserDetails()
@@ -2006,23 +1975,29 @@ void search_widget::createED2KLink()
 }
 
 SWSortFilterProxyModel::SWSortFilterProxyModel(QObject* parent):
-    QSortFilterProxyModel(parent), m_showOwn(true)
+    QSortFilterProxyModel(parent), m_showOwn(true), m_hashFilter(false)
 {
 }
 
 bool SWSortFilterProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
 {
-    QString name1 = sourceModel()->data(
-        sourceModel()->index(left.row(), SWDelegate::SW_NAME)).toString();
-    QString name2 = sourceModel()->data(
-        sourceModel()->index(right.row(), SWDelegate::SW_NAME)).toString();
-    bool torr1 = misc::isTorrentLink(name1);
-    bool torr2 = misc::isTorrentLink(name2);
+    const SearchResultModel* model = static_cast<const SearchResultModel*>(sourceModel());
+    bool torr1 = model->isTorrentLink(left);
+    bool torr2 = model->isTorrentLink(right);
 
     if (torr1 && !torr2) return sortOrder() == Qt::DescendingOrder;
     else if (!torr1 && torr2) return sortOrder() == Qt::AscendingOrder;
 
-    return QSortFilterProxyModel::lessThan(left, right);
+    // typed columns of source model, no QVariant on every comparison
+    return model->lessThan(left, right);
+}
+
+void SWSortFilterProxyModel::setHashFilter(const QSet<QString>& hashes, bool active)
+{
+    if (!active && !m_hashFilter) return;
+    m_hashes = hashes;
+    m_hashFilter = active;
+    invalidateFilter();
 }
 
 void SWSortFilterProxyModel::showOwn(bool f)
@@ -2031,25 +2006,30 @@ void SWSortFilterProxyModel::showOwn(bool f)
     invalidateFilter();
 }
 
+void SWSortFilterProxyModel::deferSorting(bool defer)
+{
+    if (dynamicSortFilter() != defer) return;
+
+    // without dynamic sorting inserted rows are not compared and changed rows are not filtered,
+    // enabling it sorts all rows and filter catches up with rows changed meanwhile
+    setDynamicSortFilter(!defer);
+    if (!defer)
+        invalidateFilter();
+}
+
 bool SWSortFilterProxyModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
 {
-    if (!m_showOwn)
+    if (!m_showOwn || m_hashFilter)
     {
         QString hash = sourceModel()->index(
             source_row, SWDelegate::SW_ID, source_parent).data().toString();
-        return !inSession(hash);
-    }
-    return true;
-}
 
-QVariant SWItemModel::data(const QModelIndex& inx, int role) const
-{
-    QVariant res;
+        if (m_hashFilter && !m_hashes.contains(hash))
+            return false;
 
-    if (role == Qt::ForegroundRole && inx.column() == SWDelegate::SW_NAME)
-        res = QVariant(itemColor(inx));
-    else
-        res = QStandardItemModel::data(inx, role);
+        if (!m_showOwn && inSession(hash))
+            return false;
+    }
 
-    return res;
+    return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
 }
@@ -2,20 +2,23 @@
 #define SEARCH_WIDGET_H
 
 #include <QWidget>
-#include <QWebView>
+#include <QHash>
 #include <QSortFilterProxyModel>
 
 #include "ui_search_widget.h"
 #include "search_widget_delegate.h"
 #include "qtlibed2k/qed2ksession.h"
+#include "transport/file_name_index.h"
+#include "torrent_search.h"
 
 QT_BEGIN_NAMESPACE
 class QSortFilterProxyModel;
-class QStandardItemModel;
 QT_END_NAMESPACE
 
 class SWDelegate;
 class search_filter;
+class SearchResultModel;
+class FileNode;
 
 enum RESULT_TYPE
 {
@@ -40,9 +43,9 @@ struct UserDir
 struct SearchResult
 {
     SearchResult(QString request, RESULT_TYPE type, const std::vector<QED2KSearchResultEntry>& vRes) : 
-        strRequest(request), resultType(type), vecResults(vRes), vecUserDirs(), netPoint() {}
+        strRequest(request), resultType(type), vecResults(vRes), vecUserDirs(), netPoint() { indexFiles(); }
     SearchResult(QString request, RESULT_TYPE type, const std::vector<QED2KSearchResultEntry>& vRes, const std::vector<UserDir> userDirs, const libed2k::net_identifier& np) : 
-        strRequest(request), resultType(type), vecResults(vRes), vecUserDirs(userDirs), netPoint(np) {}
+        strRequest(request), resultType(type), vecResults(vRes), vecUserDirs(userDirs), netPoint(np) { indexFiles(); }
     SearchResult(Preferences& pref);
 
     QString strRequest;
@@ -50,7 +53,14 @@ struct SearchResult
     std::vector<QED2KSearchResultEntry> vecResults;
     std::vector<UserDir> vecUserDirs;
     libed2k::net_identifier netPoint;
+    QHash<QString, int> fileRows;   // ed2k file hash to position in vecResults
     void save(Preferences& pref) const;
+    /**
+      * adds entry or merges it into file with same hash, returns position of file which got more sources or -1
+     */
+    int mergeFile(const QED2KSearchResultEntry& entry);
+private:
+    void indexFiles();
 };
 
 class SWTabBar : public QTabBar
@@ -67,11 +77,21 @@ public:
     SWSortFilterProxyModel(QObject* parent = 0);
     virtual bool lessThan(const QModelIndex& left, const QModelIndex& right) const;
     void showOwn(bool f);
+    /**
+      * rows come unsorted at the end while sorting is deferred, all rows are sorted once at its end
+     */
+    void deferSorting(bool defer);
+    /**
+      * only rows with these hashes are shown while hash filter is active
+     */
+    void setHashFilter(const QSet<QString>& hashes, bool active);
 protected:
     virtual bool filterAcceptsRow(int source_row, const QModelIndex& source_parent) const;
 
 private:
     bool m_showOwn;
+    bool m_hashFilter;
+    QSet<QString> m_hashes;
 };
 
 class search_widget : public QWidget , private Ui::search_widget
@@ -97,11 +117,13 @@ private:
     QIcon iconSerachActive;
     QIcon iconSearchResult;
     QIcon iconUserFiles;
-    QScopedPointer<QStandardItemModel> model;
+    QScopedPointer<SearchResultModel> model;
     QScopedPointer<SWSortFilterProxyModel> filterModel;
     SWDelegate* itemDelegate;
-    //search_filter* searchFilter;
+    search_filter* searchFilter;
     QString        m_lastSearchFileType;
+    FileNameIndex  resultNames;    // names of files of all result tabs
+    QString        localFilter;
 
     QMenu* userMenu;
     QAction* userUpdate;
@@ -129,7 +151,7 @@ private:
     QIcon iconFolder;
     QIcon iconUser;
 
-    QWebView* torrentSearchView;
+    QScopedPointer<TorrentSearchProvider> torrentSearch;
 
 public:
     search_widget(QWidget *parent = 0);
@@ -141,9 +163,8 @@ private:
     void addCondRow();
     void clearSearchTable();
     void showErrorParamMsg(int numParam);
-    void setUserPicture(const libed2k::net_identifier& np, QIcon& icon);
+    void setUserPicture(const libed2k::net_identifier& np, bool connected);
     bool findSelectedUser(QED2KSearchResultEntry& entry);
-    void fillFileValues(int row, const QED2KSearchResultEntry& fileEntry, const QModelIndex& parent = QModelIndex());
     bool hasSelectedMedia();
     bool hasSelectedFiles();
     void updateFileActions();
@@ -155,6 +176,10 @@ private:
     void warnDisconnected();
     void prepareNewSearch(
         const QString& reqType, const QString& reqText, RESULT_TYPE resultType, const QIcon& icon);
+    void appendRows(int nTabNum, size_t first, QList<int>& expanded);
+    void updateLocalFilter();
+    void indexFiles(int nTabNum, size_t first);
+    void unindexFiles(int nTabNum);
 
 private slots:
     void itemCondClicked(QTableWidgetItem* item);
@@ -187,30 +212,23 @@ private slots:
     void requestUserDirs();
     void processUserDirs(const libed2k::net_identifier& np, const QString& hash, const QStringList& strList);
     void processUserFiles(const libed2k::net_identifier& np, const QString& hash,
-                          const QString& strDirectory, const std::vector<QED2KSearchResultEntry>& vRes);
+                          const QString& strDirectory, const QED2KSearchResultBatch& batch);
     void processIsModSharedFiles(const libed2k::net_identifier& np, const QString& hash, const QString& dir_hash,
-                                 const std::vector<QED2KSearchResultEntry>& vRes);
+                                 const QED2KSearchResultBatch& batch);
     void itemCollapsed(const QModelIndex& index);
     void itemExpanded(const QModelIndex& index);
     void displayHSMenu(const QPoint&);
 
     void ed2kSearchFinished(const libed2k::net_identifier& np,const QString& hash,
-                            const std::vector<QED2KSearchResultEntry>& vRes, bool bMoreResult);
-    void torrentSearchFinished(bool ok);
+                            const QED2KSearchResultBatch& batch, bool bMoreResult);
+    void torrentSearchFinished(bool ok, const QList<TorrentSearchRow>& rows);
     void addedTransfer(Transfer t);
     void deletedTransfer(const QString& hash);
+    void sharedFileChanged(FileNode* node);
 
 signals:
     void sendMessage(const QString& user_name, const libed2k::net_identifier& np);
     void addFriend(const QString& user_name, const libed2k::net_identifier& np);
 };
 
-class SWItemModel : public QStandardItemModel
-{
-public:
-    SWItemModel(int rows, int columns, QObject * parent = 0):
-        QStandardItemModel(rows, columns, parent){}
-    virtual QVariant data(const QModelIndex & index, int role = Qt::DisplayRole) const;
-};
-
 #endif // SEARCH_WIDGET_H
@@ -78,9 +78,7 @@ public:
             }
             case SW_SOURCES:
             {
-                const QAbstractItemModel* model = index.model();
-                int sources = model->data(
-                    model->index(index.row(), SWDelegate::SW_AVAILABILITY)).toInt();
+                int sources = index.sibling(index.row(), SWDelegate::SW_AVAILABILITY).data().toInt();
                 int completeSources = index.data().toInt();
 
                 QString strSrc = (sources > 0) ?
@@ -1,16 +1,18 @@
 #include "base_model.h"
 #include "misc.h"
 #include "session.h"
+#include "file_type_provider.h"
 
 BaseModel::BaseModel(DirNode* root, QObject *parent/* = 0*/) :
     QAbstractItemModel(parent), m_rootItem(root), m_row_count_changed(false)
 {
     // integrate model into session
-    connect(Session::instance(), SIGNAL(changeNode(const FileNode*)), this, SLOT(changeNode(const FileNode*)));
+    connect(Session::instance(), SIGNAL(changeNodes(const QList<const FileNode*>&)), this, SLOT(changeNodes(const QList<const FileNode*>&)));
     connect(Session::instance(), SIGNAL(beginRemoveNode(const FileNode*)), this, SLOT(beginRemoveNode(const FileNode*)));
     connect(Session::instance(), SIGNAL(endRemoveNode()), this, SLOT(endRemoveNode()));
-    connect(Session::instance(), SIGNAL(beginInsertNode(const FileNode*)), this, SLOT(beginInsertNode(const FileNode*)));
-    connect(Session::instance(), SIGNAL(endInsertNode()), this, SLOT(endInsertNode()));
+    connect(Session::instance(), SIGNAL(beginInsertNodes(const DirNode*, bool, int)), this, SLOT(beginInsertNodes(const DirNode*, bool, int)));
+    connect(Session::instance(), SIGNAL(endInsertNodes()), this, SLOT(endInsertNodes()));
+    connect(FileTypeProvider::instance(), SIGNAL(resolved(const QStringList&)), this, SLOT(typesResolved(const QStringList&)));
 }
 
 BaseModel::~BaseModel()
@@ -25,35 +27,13 @@ QModelIndex BaseModel::parent(const QModelIndex &index) const
     FileNode* childItem = static_cast<FileNode*>(index.internalPointer());
     DirNode* parentItem = childItem->m_parent;
 
-    if (parentItem == m_rootItem)
+    if (parentItem == m_rootItem || !parentItem->m_parent)
     {
         return QModelIndex();
     }
 
-    bool found = false;
-    int row = 0;
-
-    if (parentItem->m_parent)
-    {
-        foreach(const DirNode* p, parentItem->m_parent->m_dir_vector) // search parent in grand parent!
-        {
-            if (p == parentItem)
-            {
-                found = true;
-                break;
-            }
-
-            ++row;
-        }
-
-        if (found)
-        {
-            return createIndex(row, 0, parentItem);
-        }
-    }
-
-    return QModelIndex();
-
+    // row of parent in grand parent
+    return createIndex(parentItem->m_row, 0, parentItem);
 }
 
 
@@ -79,6 +59,7 @@ void BaseModel::setRootNode(const QModelIndex& index)
     {
         qDebug() << "set index to " << static_cast<DirNode*>(index.internalPointer())->filepath();
         m_rootItem = static_cast<DirNode*>(index.internalPointer());
+        m_type_waiters.clear();
         reset();
     }
 }
@@ -89,6 +70,7 @@ void BaseModel::setRootNode(DirNode* node)
     {
         qDebug() << "set index to " << node->filepath();
         m_rootItem = node;
+        m_type_waiters.clear();
         reset();
     }
 }
@@ -123,13 +105,9 @@ QString BaseModel::type(const QModelIndex &index) const
 {
     if (!index.isValid()) return QString();
     FileNode* p = node(index);
-
-    if (p->m_displayType.isEmpty())
-    {
-        p->m_displayType = m_iconProvider.type(p->m_info);
-    }
-
-    return p->m_displayType;
+    QString key = FileTypeProvider::instance()->key(p->m_info);
+    waitType(key, index);
+    return FileTypeProvider::instance()->type(key, p->m_info);
 }
 
 QDateTime BaseModel::lastModified(const QModelIndex &index) const
@@ -142,13 +120,9 @@ QIcon BaseModel::icon(const QModelIndex& index) const
 {
     if (!index.isValid()) return QIcon();
     FileNode* p = node(index);
-
-    if (p->m_icon.isNull())
-    {
-        p->m_icon = m_iconProvider.icon(p->m_info);
-    }
-
-    return p->m_icon;
+    QString key = FileTypeProvider::instance()->key(p->m_info);
+    waitType(key, index);
+    return FileTypeProvider::instance()->icon(key, p->m_info);
 }
 
 QString BaseModel::displayName(const QModelIndex &index) const
@@ -262,6 +236,38 @@ Qt::CheckState BaseModel::state(const QModelIndex& index) const
     return st;
 }
 
+void BaseModel::waitType(const QString& key, const QModelIndex& index) const
+{
+    if (FileTypeProvider::instance()->is_resolved(key)) return;
+    m_type_waiters[key].insert(node(index));
+}
+
+void BaseModel::dropWaiters(const FileNode* node)
+{
+    QHash<QString, QSet<const FileNode*> >::iterator itr = m_type_waiters.begin();
+
+    while (itr != m_type_waiters.end())
+    {
+        QSet<const FileNode*>::iterator n = itr->begin();
+
+        while (n != itr->end())
+        {
+            const FileNode* p = *n;
+            while (p && p != node) p = p->m_parent;
+
+            if (p)
+                n = itr->erase(n);
+            else
+                ++n;
+        }
+
+        if (itr->isEmpty())
+            itr = m_type_waiters.erase(itr);
+        else
+            ++itr;
+    }
+}
+
 FileNode* BaseModel::node(const QModelIndex& index) const
 {
     FileNode* p = static_cast<FileNode*>(index.internalPointer());
@@ -271,20 +277,74 @@ FileNode* BaseModel::node(const QModelIndex& index) const
 
 
 // slots
-void BaseModel::changeNode(const FileNode* node)
+void BaseModel::changeNodes(const QList<const FileNode*>& nodes)
 {
-    QModelIndex indx = index(node);        
+    typedef QMap<int, const FileNode*> Rows;
+    // changed rows grouped by parent index
+    QHash<void*, Rows> groups;
 
-    if (indx.isValid())
+    foreach(const FileNode* node, nodes)
     {
-        emitChangeSignal(indx);
+        QModelIndex indx = index(node);
+
+        if (indx.isValid())
+        {
+            groups[parent(indx).internalPointer()].insert(indx.row(), node);
+        }
+    }
+
+    // emit one signal per contiguous rows range
+    foreach(const Rows& rows, groups)
+    {
+        Rows::const_iterator first = rows.begin();
+        Rows::const_iterator last = first;
+
+        for (Rows::const_iterator itr = rows.begin(); itr != rows.end(); ++itr)
+        {
+            if (itr.key() > last.key() + 1)
+            {
+                emit dataChanged(createIndex(first.key(), 0, const_cast<FileNode*>(first.value())),
+                                 createIndex(last.key(), colcount() - 1, const_cast<FileNode*>(last.value())));
+                first = itr;
+            }
+
+            last = itr;
+        }
+
+        emit dataChanged(createIndex(first.key(), 0, const_cast<FileNode*>(first.value())),
+                         createIndex(last.key(), colcount() - 1, const_cast<FileNode*>(last.value())));
+    }
+}
+
+void BaseModel::typesResolved(const QStringList& keys)
+{
+    foreach(const QString& key, keys)
+    {
+        QHash<QString, QSet<const FileNode*> >::iterator itr = m_type_waiters.find(key);
+        if (itr == m_type_waiters.end()) continue;
+        QSet<const FileNode*> nodes = itr.value();
+        m_type_waiters.erase(itr);
+
+        foreach(const FileNode* node, nodes)
+        {
+            // node could leave model after it was painted
+            QModelIndex indx = node2index(node);
+
+            if (indx.isValid() && indx.row() >= 0)
+            {
+                emit dataChanged(indx, createIndex(indx.row(), colcount() - 1, const_cast<FileNode*>(node)));
+            }
+        }
     }
 }
 
 void BaseModel::beginRemoveNode(const FileNode* node)
 {
-    QModelIndex indx = index(node);
     m_row_count_changed = false;
+    if (!m_type_waiters.isEmpty()) dropWaiters(node);
+    if (!accepts(node->m_parent, node->is_dir())) return;
+
+    QModelIndex indx = index(node);
 
     if (indx.isValid())
     {
@@ -303,33 +363,19 @@ void BaseModel::endRemoveNode()
     }
 }
 
-void BaseModel::beginInsertNode(const FileNode* node)
+void BaseModel::beginInsertNodes(const DirNode* parent, bool dirs, int count)
 {
-    QModelIndex indx = index(node);
     m_row_count_changed = false;
+    if (!accepts(parent, dirs)) return;
 
-    if (indx.isValid())
-    {
-        int row = 0;
-        FileNode* node = static_cast<FileNode*>(indx.internalPointer());
-        DirNode* parent_node = node->m_parent;
-
-        if (node->is_dir())
-        {
-            row = parent_node->m_dir_vector.size();
-        }
-        else
-        {
-            row = parent_node->m_file_vector.size();
-        }
-
-        qDebug() << "beginInsertNode row: " << row;
-        beginInsertRows(index(parent_node), row, row);
-        m_row_count_changed = true;
-    }
+    int row = dirs ? parent->m_dir_vector.size() : parent->m_file_vector.size();
+    QModelIndex parent_index = (parent == m_rootItem) ? QModelIndex() : index(parent);
+    qDebug() << "beginInsertNodes rows: " << row << " count " << count;
+    beginInsertRows(parent_index, row, row + count - 1);
+    m_row_count_changed = true;
 }
 
-void BaseModel::endInsertNode()
+void BaseModel::endInsertNodes()
 {
     if (m_row_count_changed)
     {
@@ -4,6 +4,10 @@
 #include <QAbstractItemModel>
 #include <QModelIndex>
 #include <QVariant>
+#include <QMap>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
 #include "transport/session_filesystem.h"
 
 class BaseModel : public QAbstractItemModel
@@ -64,21 +68,35 @@ public:
 protected:
      int elements_count(const DirNode* node) const;
      FileNode* node(const QModelIndex& index) const;
+
+     /**
+       * remember node to update its row when icon and type of key will be resolved
+      */
+     void waitType(const QString& key, const QModelIndex& index) const;
+     /**
+       * node and its children will be deleted, don't wait types for them
+      */
+     void dropWaiters(const FileNode* node);
      virtual QModelIndex node2index(const FileNode*) const = 0;
      virtual int node2row(const FileNode*) const = 0;
      virtual int colcount() const = 0;
-     virtual void emitChangeSignal(const QModelIndex& index) = 0;
+
+     /**
+       * model contains directories or files rows of parent node
+      */
+     virtual bool accepts(const DirNode* parent, bool dirs) const = 0;
 
      DirNode*   m_rootItem;
      bool       m_row_count_changed;
-     QFileIconProvider  m_iconProvider;
+     mutable QHash<QString, QSet<const FileNode*> > m_type_waiters;
 public slots:
 
-    void changeNode(const FileNode* node);
+    void changeNodes(const QList<const FileNode*>& nodes);
+    void typesResolved(const QStringList& keys);
     void beginRemoveNode(const FileNode* node);
     void endRemoveNode();
-    void beginInsertNode(const FileNode* node);
-    void endInsertNode();
+    void beginInsertNodes(const DirNode* parent, bool dirs, int count);
+    void endInsertNodes();
 };
 
 
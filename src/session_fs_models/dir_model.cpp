@@ -80,19 +80,8 @@ QModelIndex DirectoryModel::node2index(const FileNode* node) const
 
 int DirectoryModel::node2row(const FileNode* node) const
 {
-    int row = -1;
-
-    if (node != m_rootItem)
-    {
-        row = 0;
-        foreach(const DirNode* p, node->m_parent->m_dir_vector)
-        {
-            if (p == node) break;
-            ++row;
-        }
-    }
-
-    return row;
+    if (node == m_rootItem) return -1;
+    return node->m_row;
 }
 
 
@@ -138,14 +127,6 @@ QVariant DirectoryModel::data(const QModelIndex &index, int role) const
         {
             QIcon icon = this->icon(index);
 
-            if (icon.isNull())
-            {
-                if (node(index)->is_dir())
-                    icon = m_iconProvider.icon(QFileIconProvider::Folder);
-                else
-                    icon = m_iconProvider.icon(QFileIconProvider::File);
-            }
-
             if (this->active(index))
             {
                 // prepare mule head
@@ -178,8 +159,3 @@ QVariant DirectoryModel::data(const QModelIndex &index, int role) const
 
     return res;
 }
-
-void DirectoryModel::emitChangeSignal(const QModelIndex& indx)
-{
-    emit dataChanged(indx, indx);
-}
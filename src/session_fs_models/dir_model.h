@@ -21,7 +21,7 @@ protected:
     virtual QModelIndex node2index(const FileNode*) const;
     virtual int node2row(const FileNode*) const;
     virtual int colcount() const { return 1; }
-    virtual void emitChangeSignal(const QModelIndex&);
+    virtual bool accepts(const DirNode* parent, bool dirs) const { return dirs && parent != NULL; }
 };
 
 #endif // __DIR_MODEL__H__
@@ -1,4 +1,37 @@
 #include "file_filter.h"
+#include "transport/session_filesystem.h"
+
+libed2k::EED2KFileType file_type(const QString& filename)
+{
+    return libed2k::GetED2KFileTypeID(filename.toLower().toStdString());
+}
+
+void SharedFilesIndex::insert(FileNode* node)
+{
+    if (m_all.contains(node)) return;
+    int type = file_type(node->filename());
+    m_all.insert(node);
+    const QString path = node->parent_path();
+    m_types.insert(node, type);
+    m_paths.insert(node, path);
+    m_by_type[type].insert(node);
+    m_by_path[path].insert(node);
+}
+
+void SharedFilesIndex::remove(FileNode* node)
+{
+    if (!m_all.remove(node)) return;
+    int type = m_types.take(node);
+    QString path = m_paths.take(node);
+
+    QHash<int, QSet<FileNode*> >::iterator titr = m_by_type.find(type);
+    if (titr != m_by_type.end() && titr->remove(node) && titr->isEmpty())
+        m_by_type.erase(titr);
+
+    QHash<QString, QSet<FileNode*> >::iterator pitr = m_by_path.find(path);
+    if (pitr != m_by_path.end() && pitr->remove(node) && pitr->isEmpty())
+        m_by_path.erase(pitr);
+}
 
 
 PathFilter::PathFilter(const QString& parent_path) : m_parentpath(parent_path)
@@ -11,5 +44,5 @@ TypeFilter::TypeFilter(libed2k::EED2KFileType type) : m_type(type)
 bool TypeFilter::match(const QString& parent_path, const QString& filename) const
 {
     Q_UNUSED(parent_path);
-    return (m_type == libed2k::GetED2KFileTypeID(filename.toLower().toStdString()));
+    return (m_type == file_type(filename));
 }
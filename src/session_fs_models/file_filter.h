@@ -2,8 +2,33 @@
 #define __FILE_FILTER__
 
 #include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
 #include <libed2k/file.hpp>
 
+class FileNode;
+
+/**
+  * shared files grouped by ed2k file type and by parent directory path
+  * filters select files from it without matching every file
+ */
+class SharedFilesIndex
+{
+public:
+    void insert(FileNode* node);
+    void remove(FileNode* node);
+
+    QSet<FileNode*>                     m_all;
+    QHash<int, QSet<FileNode*> >        m_by_type;
+    QHash<QString, QSet<FileNode*> >    m_by_path;
+private:
+    QHash<FileNode*, int>               m_types;    // type of file at insert time
+    QHash<FileNode*, QString>           m_paths;    // parent path of file at insert time
+};
+
+libed2k::EED2KFileType file_type(const QString& filename);
+
 /**
   * base filter, always true
  */
@@ -11,6 +36,7 @@ class BaseFilter
 {
 public:
     virtual bool match(const QString& parent_path, const QString& filename) const { return true; }
+    virtual QList<FileNode*> select(const SharedFilesIndex& index) const { return index.m_all.toList(); }
     virtual ~BaseFilter() {}
 };
 
@@ -24,6 +50,7 @@ private:
 public:
     PathFilter(const QString& parent_path);
     virtual bool match(const QString& parent_path, const QString& filename) const { return parent_path == m_parentpath;}
+    virtual QList<FileNode*> select(const SharedFilesIndex& index) const { return index.m_by_path.value(m_parentpath).toList(); }
 };
 
 /**
@@ -36,6 +63,7 @@ private:
 public:
     TypeFilter(libed2k::EED2KFileType type);
     virtual bool match(const QString& parent_path, const QString& filename) const;
+    virtual QList<FileNode*> select(const SharedFilesIndex& index) const { return index.m_by_type.value(m_type).toList(); }
 };
 
 #endif
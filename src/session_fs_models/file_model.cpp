@@ -177,14 +177,6 @@ QVariant FilesModel::data(const QModelIndex &index, int role) const
         if (index.column() == DC_NAME)
         {
             QIcon icon = this->icon(index);
-
-            if (icon.isNull())
-            {
-                if (node(index)->is_dir())
-                    icon = m_iconProvider.icon(QFileIconProvider::Folder);
-                else
-                    icon = m_iconProvider.icon(QFileIconProvider::File);
-            }
             return icon;
         }
 
@@ -250,24 +242,6 @@ QModelIndex FilesModel::node2index(const FileNode* node) const
 
 int FilesModel::node2row(const FileNode* node) const
 {
-    int row = -1;
-
-    if (node != m_rootItem)
-    {
-        row = 0;
-        foreach(const FileNode* p, node->m_parent->m_file_vector)
-        {
-            if (p == node) break;
-            ++row;
-        }
-    }
-
-    return row;
-}
-
-void FilesModel::emitChangeSignal(const QModelIndex& indx)
-{
-    emit dataChanged(indx, indx);
-    emit dataChanged(index(indx.row(), columnCount() - 2, parent(indx)),
-                               index(indx.row(), columnCount() - 1, parent(indx)));
+    if (node == m_rootItem) return -1;
+    return node->m_row;
 }
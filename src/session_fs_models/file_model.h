@@ -22,7 +22,7 @@ protected:
     virtual QModelIndex node2index(const FileNode*) const;
     virtual int node2row(const FileNode*) const;    
     virtual int colcount() const { return 7; };
-    virtual void emitChangeSignal(const QModelIndex&);
+    virtual bool accepts(const DirNode* parent, bool dirs) const { return !dirs && parent == m_rootItem; }
 };
 
 #endif // __FILE_MODEL__H__
@@ -0,0 +1,169 @@
+#include <QMutexLocker>
+
+#include "file_type_provider.h"
+
+FileTypeResolver::FileTypeResolver(QObject* parent /*= 0*/) : QThread(parent), m_abort(false)
+{
+}
+
+FileTypeResolver::~FileTypeResolver()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_abort = true;
+        m_cond.wakeOne();
+    }
+
+    wait();
+}
+
+void FileTypeResolver::enqueue(const Request& req)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue << req;
+    m_cond.wakeOne();
+}
+
+QList<FileTypeResolver::Result> FileTypeResolver::takeResults()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<Result> res;
+    res.swap(m_results);
+    return res;
+}
+
+void FileTypeResolver::run()
+{
+    // provider used by this thread only
+    QFileIconProvider provider;
+
+    forever
+    {
+        QList<Request> batch;
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while (m_queue.isEmpty() && !m_abort)
+                m_cond.wait(&m_mutex);
+
+            if (m_abort) break;
+            batch.swap(m_queue);
+        }
+
+        QList<Result> results;
+
+        foreach(const Request& req, batch)
+        {
+            results << qMakePair(req, provider.type(req.second));
+        }
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_results << results;
+        }
+
+        emit typesReady();
+    }
+}
+
+FileTypeProvider* FileTypeProvider::m_instance = 0;
+
+FileTypeProvider* FileTypeProvider::instance()
+{
+    if (!m_instance)
+        m_instance = new FileTypeProvider;
+    return m_instance;
+}
+
+void FileTypeProvider::drop()
+{
+    if (m_instance)
+    {
+        delete m_instance;
+        m_instance = 0;
+    }
+}
+
+FileTypeProvider::FileTypeProvider()
+{
+    m_folder_icon = m_provider.icon(QFileIconProvider::Folder);
+    m_file_icon = m_provider.icon(QFileIconProvider::File);
+    connect(&m_resolver, SIGNAL(typesReady()), this, SLOT(on_typesReady()), Qt::QueuedConnection);
+    m_resolver.start(QThread::LowPriority);
+}
+
+FileTypeProvider::~FileTypeProvider()
+{
+}
+
+QString FileTypeProvider::key(const QFileInfo& info) const
+{
+    if (info.isDir())
+    {
+        return info.isRoot() ? (QString("drive:") + info.absoluteFilePath()) : QString("/");
+    }
+
+    QString suffix = info.suffix().toLower();
+
+    // these files carry own icons
+    if (suffix == "exe" || suffix == "lnk" || suffix == "ico" || suffix == "url" ||
+        suffix == "scr" || suffix == "cur" || suffix == "ani")
+    {
+        return QString("path:") + info.absoluteFilePath();
+    }
+
+    return QString(".") + suffix;
+}
+
+bool FileTypeProvider::is_resolved(const QString& key) const
+{
+    QHash<QString, Entry>::const_iterator itr = m_cache.find(key);
+    return (itr != m_cache.end() && itr->m_resolved);
+}
+
+QIcon FileTypeProvider::icon(const QString& key, const QFileInfo& info)
+{
+    return entry(key, info).m_icon;
+}
+
+QString FileTypeProvider::type(const QString& key, const QFileInfo& info)
+{
+    return entry(key, info).m_type;
+}
+
+FileTypeProvider::Entry& FileTypeProvider::entry(const QString& key, const QFileInfo& info)
+{
+    QHash<QString, Entry>::iterator itr = m_cache.find(key);
+
+    if (itr == m_cache.end())
+    {
+        // generic icon until resolution completes
+        itr = m_cache.insert(key, Entry());
+        itr->m_icon = info.isDir() ? m_folder_icon : m_file_icon;
+        m_resolver.enqueue(qMakePair(key, info));
+    }
+
+    return *itr;
+}
+
+void FileTypeProvider::on_typesReady()
+{
+    QList<FileTypeResolver::Result> results = m_resolver.takeResults();
+    if (results.isEmpty()) return;
+
+    QStringList keys;
+
+    foreach(const FileTypeResolver::Result& res, results)
+    {
+        Entry& e = m_cache[res.first.first];
+        // pixmaps are allowed in gui thread only
+        e.m_icon = m_provider.icon(res.first.second);
+        if (e.m_icon.isNull()) e.m_icon = res.first.second.isDir() ? m_folder_icon : m_file_icon;
+        e.m_type = res.second;
+        e.m_resolved = true;
+        keys << res.first.first;
+    }
+
+    emit resolved(keys);
+}
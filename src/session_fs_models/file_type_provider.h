@@ -0,0 +1,89 @@
+#ifndef __FILE_TYPE_PROVIDER__
+#define __FILE_TYPE_PROVIDER__
+
+#include <QObject>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFileIconProvider>
+#include <QFileInfo>
+#include <QIcon>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QPair>
+
+/**
+  * resolves type names of queued keys in background
+ */
+class FileTypeResolver : public QThread
+{
+    Q_OBJECT
+public:
+    typedef QPair<QString, QFileInfo> Request;
+    typedef QPair<Request, QString> Result;
+
+    FileTypeResolver(QObject* parent = 0);
+    ~FileTypeResolver();
+
+    void enqueue(const Request& req);
+    QList<Result> takeResults();
+protected:
+    void run();
+private:
+    bool                m_abort;
+    QWaitCondition      m_cond;
+    mutable QMutex      m_mutex;
+    QList<Request>      m_queue;
+    QList<Result>       m_results;
+signals:
+    void typesReady();
+};
+
+/**
+  * shared icon and type cache for session filesystem views
+  * files share entry by lower case extension, directories share one entry,
+  * drives and files with own icons(executables, shortcuts, icons) have entry per path
+  * unknown keys return generic icon and empty type until resolution completes
+ */
+class FileTypeProvider : public QObject
+{
+    Q_OBJECT
+public:
+    static FileTypeProvider* instance();
+    static void drop();
+
+    QString key(const QFileInfo& info) const;
+    bool is_resolved(const QString& key) const;
+    QIcon icon(const QString& key, const QFileInfo& info);
+    QString type(const QString& key, const QFileInfo& info);
+private:
+    struct Entry
+    {
+        QIcon   m_icon;
+        QString m_type;
+        bool    m_resolved;
+        Entry() : m_resolved(false) {}
+    };
+
+    FileTypeProvider();
+    ~FileTypeProvider();
+    Entry& entry(const QString& key, const QFileInfo& info);
+
+    static FileTypeProvider* m_instance;
+    QFileIconProvider       m_provider;
+    FileTypeResolver        m_resolver;
+    QHash<QString, Entry>   m_cache;
+    QIcon                   m_folder_icon;
+    QIcon                   m_file_icon;
+private slots:
+    void on_typesReady();
+signals:
+    /**
+      * icons and types of keys are available
+     */
+    void resolved(const QStringList& keys);
+};
+
+#endif //__FILE_TYPE_PROVIDER__
@@ -1,5 +1,6 @@
 #include "path_model.h"
 #include "session.h"
+#include "natural_sort.h"
 
 PathModel::PathModel(QObject *parent /* = 0*/)
     : QAbstractListModel(parent)
@@ -7,6 +8,7 @@ PathModel::PathModel(QObject *parent /* = 0*/)
     foreach(const DirNode* node, Session::instance()->directories())
     {
         m_paths.append(node);
+        m_keys.append(naturalKey(node->filepath()));
     }
 
     connect(Session::instance(), SIGNAL(insertSharedDirectory(const DirNode*)), this, SLOT(on_insertSharedDirectory(const DirNode*)));
@@ -152,6 +154,21 @@ const QString PathModel::filepath(const QModelIndex& indx) const
     return res;
 }
 
+const QString PathModel::sort_key(const QModelIndex& indx) const
+{
+    QString res;
+
+    if (indx.isValid())
+    {
+        if (indx.row() >= filters_count)
+        {
+            res = m_keys.at(indx.row() - filters_count);
+        }
+    }
+
+    return res;
+}
+
 BaseFilter* PathModel::filter(const QModelIndex& index) const
 {
     BaseFilter* res = NULL;
@@ -183,6 +200,7 @@ void PathModel::on_removeSharedDirectory(const DirNode* node)
     {
         beginRemoveRows(QModelIndex(), row, row);
         m_paths.removeAt(row);
+        m_keys.removeAt(row);
         endRemoveRows();
     }
 }
@@ -193,6 +211,7 @@ void PathModel::on_insertSharedDirectory(const DirNode* node)
     {
         beginInsertRows(QModelIndex(), m_paths.size(), m_paths.size());
         m_paths.append(node);
+        m_keys.append(naturalKey(node->filepath()));
         endInsertRows();
     }
 }
@@ -20,12 +20,14 @@ public:
                         int role = Qt::DisplayRole) const;
     const DirNode* node(const QModelIndex&) const;
     const QString filepath(const QModelIndex&) const;
+    const QString sort_key(const QModelIndex&) const;
     BaseFilter* filter(const QModelIndex&) const;
 public slots:
     void on_removeSharedDirectory(const DirNode*);
     void on_insertSharedDirectory(const DirNode*);
 private:
     QList<const DirNode*> m_paths;
+    QStringList m_keys;     // natural sort keys of paths
     int node2row(const DirNode*) const;
 };
 
@@ -6,7 +6,8 @@ HEADERS += $$PWD/base_model.h \
            $$PWD/sort_model.h \
            $$PWD/path_model.h \
            $$PWD/shared_files_model.h \
-           $$PWD/file_filter.h
+           $$PWD/file_filter.h \
+           $$PWD/file_type_provider.h
 
 SOURCES += $$PWD/base_model.cpp \
            $$PWD/file_model.cpp \
@@ -14,4 +15,5 @@ SOURCES += $$PWD/base_model.cpp \
            $$PWD/sort_model.cpp \
            $$PWD/path_model.cpp \
            $$PWD/shared_files_model.cpp \
-           $$PWD/file_filter.cpp
+           $$PWD/file_filter.cpp \
+           $$PWD/file_type_provider.cpp
@@ -1,7 +1,12 @@
 #include "shared_files_model.h"
 
-SFModel::SFModel(QObject *parent /*= 0*/) : FilesModel(Session::instance()->root(), parent)
+SFModel::SFModel(QObject *parent /*= 0*/) : FilesModel(Session::instance()->root(), parent), m_count(0)
 {
+    foreach(FileNode* p, Session::instance()->files())
+    {
+        m_index.insert(p);
+    }
+
     sync();
     connect(Session::instance(), SIGNAL(removeSharedFile(FileNode*)), this, SLOT(on_removeSharedFile(FileNode*)));
     connect(Session::instance(), SIGNAL(insertSharedFile(FileNode*)), this, SLOT(on_insertSharedFile(FileNode*)));
@@ -9,7 +14,7 @@ SFModel::SFModel(QObject *parent /*= 0*/) : FilesModel(Session::instance()->root
 
 int SFModel::rowCount(const QModelIndex &parent /*= QModelIndex()*/) const
 {
-    return m_files.size();
+    return m_count;
 }
 
 QModelIndex SFModel::parent(const QModelIndex &index) const
@@ -32,60 +37,131 @@ QModelIndex SFModel::index(int row, int column,
 
     Q_ASSERT(row < rowCount(parent));
 
-    FileNode *childNode = m_files.at(row);
+    FileNode *childNode = m_slots.at(row2slot(row));
     Q_ASSERT(childNode);
     return createIndex(row, column, childNode);
 }
 
 void SFModel::setFilter(BaseFilter* filter)
 {
+    beginResetModel();
     m_filter.reset(filter);
-    m_files.clear();
     sync();
-    reset();
+    endResetModel();
 }
 
 int SFModel::node2row(const FileNode* node) const
 {
-    int row = -1;
+    QHash<const FileNode*, int>::const_iterator itr = m_slot_of.find(node);
+    if (itr == m_slot_of.end()) return -1;
+    return prefix(itr.value());
+}
+
+void SFModel::sync()
+{
+    rebuild(m_filter.isNull() ? QList<FileNode*>() : m_filter->select(m_index));
+}
+
+void SFModel::rebuild(const QList<FileNode*>& files)
+{
+    m_slots = files.toVector();
+    m_count = m_slots.size();
+    m_slot_of.clear();
+    m_tree.fill(0, m_slots.size() + 1);
 
-    foreach(FileNode* p, m_files)
+    // linear fenwick build, every slot is occupied
+    for (int i = 1; i < m_tree.size(); ++i)
     {
-        ++row;
-        if (node == p)
-            return row;
+        m_slot_of.insert(m_slots.at(i - 1), i - 1);
+        m_tree[i] += 1;
+        int j = i + (i & -i);
+        if (j < m_tree.size()) m_tree[j] += m_tree[i];
     }
+}
 
-    return -1;
+void SFModel::appendSlot(FileNode* node)
+{
+    // new tree node counts slots (i - lowbit(i), i]
+    int i = m_slots.size() + 1;
+    m_tree.append(1 + prefix(i - 1) - prefix(i - (i & -i)));
+    m_slot_of.insert(node, m_slots.size());
+    m_slots.append(node);
+    ++m_count;
 }
 
-void SFModel::sync()
+void SFModel::clearSlot(int slot)
+{
+    m_slot_of.remove(m_slots.at(slot));
+    m_slots[slot] = NULL;
+    --m_count;
+
+    for (int i = slot + 1; i < m_tree.size(); i += i & -i)
+        --m_tree[i];
+
+    // drop empty slots when they are majority, rows don't change
+    if (m_slots.size() > 2 * m_count + 64)
+    {
+        QList<FileNode*> files;
+        files.reserve(m_count);
+
+        foreach(FileNode* p, m_slots)
+        {
+            if (p) files << p;
+        }
+
+        rebuild(files);
+    }
+}
+
+int SFModel::prefix(int count) const
+{
+    int res = 0;
+    for (int i = count; i > 0; i -= i & -i)
+        res += m_tree.at(i);
+    return res;
+}
+
+int SFModel::row2slot(int row) const
 {
-    foreach(FileNode* p, Session::instance()->files().values())
+    // descend to last tree position with less than row + 1 occupied slots before it
+    int pos = 0;
+    int rest = row + 1;
+    int step = 1;
+    while (step * 2 < m_tree.size()) step *= 2;
+
+    for (; step > 0; step /= 2)
     {
-        if (!m_filter.isNull() && (m_filter->match(p->parent_path(), p->filename())))
-            m_files.append(p);
+        if (pos + step < m_tree.size() && m_tree.at(pos + step) < rest)
+        {
+            pos += step;
+            rest -= m_tree.at(pos);
+        }
     }
+
+    return pos;
 }
 
 void SFModel::on_removeSharedFile(FileNode* node)
 {
+    m_index.remove(node);
     int row = node2row(node);
 
     if (row != -1)
     {
         beginRemoveRows(QModelIndex(), row, row);
-        m_files.removeAt(row);
+        clearSlot(m_slot_of.value(node));
         endRemoveRows();
     }
 }
 
 void SFModel::on_insertSharedFile(FileNode* node)
 {
-    if (!m_filter.isNull() && (m_filter->match(node->parent_path(), node->filename())))
+    m_index.insert(node);
+
+    if (!m_filter.isNull() && !m_slot_of.contains(node) && (m_filter->match(node->parent_path(), node->filename())))
     {
-        beginInsertRows(QModelIndex(), m_files.size(), m_files.size());
-        m_files.append(node);
+        beginInsertRows(QModelIndex(), m_count, m_count);
+        appendSlot(node);
         endInsertRows();
     }
 }
@@ -2,6 +2,7 @@
 #define __SHARED_FILES_MODEL__
 
 #include <QScopedPointer>
+#include <QVector>
 #include "file_model.h"
 #include "file_filter.h"
 #include "transport/session.h"
@@ -19,10 +20,23 @@ public slots:
     void on_removeSharedFile(FileNode*);
     void on_insertSharedFile(FileNode*);
 private:    
-    QList<FileNode*>    m_files;
+    /**
+      * files are kept in insertion slots, removed file leaves empty slot
+      * row of file is count of files in slots before it, counts are kept in fenwick tree
+     */
+    QVector<FileNode*>  m_slots;
+    QVector<int>        m_tree;     // 1-based fenwick tree of occupied slots
+    QHash<const FileNode*, int> m_slot_of;
+    int                 m_count;    // occupied slots
+    SharedFilesIndex    m_index;
     QScopedPointer<BaseFilter> m_filter;
     int node2row(const FileNode*) const;
     void sync();
+    void rebuild(const QList<FileNode*>& files);
+    void appendSlot(FileNode* node);
+    void clearSlot(int slot);
+    int prefix(int count) const;    // occupied slots in [0, count)
+    int row2slot(int row) const;
 };
 
 #endif //__SHARED_FILES_MODEL__
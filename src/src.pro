@@ -30,7 +30,6 @@ nox {
   TARGET = qmule 
 }
 QT += network
-QT += webkit
 QT += xml
 
 # Vars
@@ -101,6 +100,7 @@ include(session_fs_models/session_fs_models.pri)
 }
 
 HEADERS += misc.h \
+           natural_sort.h \
            downloadthread.h \
            stacktrace.h \
            torrentpersistentdata.h \
@@ -115,17 +115,20 @@ SOURCES += main.cpp \
            downloadthread.cpp \
            scannedfoldersmodel.cpp \
            misc.cpp \
+           natural_sort.cpp \
            smtp.cpp \
            servers_widget.cpp \
            servers_table_model.cpp
 
 HEADERS +=  mainwindow.h\
           transferlistwidget.h \
+          transferlistsortmodel.h \
           transferlistdelegate.h \
           transferlistfilterswidget.h \
           torrentcontentmodel.h \
           torrentcontentmodelitem.h \
           torrentcontentfiltermodel.h \
+          torrentcontentindex.h \
           deletionconfirmationdlg.h \
           reverseresolution.h \
           ico.h \
@@ -146,6 +149,7 @@ HEADERS +=  mainwindow.h\
           status_widget.h  \
           search_widget.h \
           search_widget_delegate.h \
+          search_result_model.h \
           search_filter.h \
           messages_widget.h \
           add_friend.h \
@@ -159,14 +163,17 @@ HEADERS +=  mainwindow.h\
           torrent_properties.h \
           ed2k_link_maker.h \
           delay.h \
-          wgetter.h
+          wgetter.h \
+          torrent_search.h
 
 SOURCES += mainwindow.cpp \
          ico.cpp \
          transferlistwidget.cpp \
+         transferlistsortmodel.cpp \
          torrentcontentmodel.cpp \
          torrentcontentmodelitem.cpp \
          torrentcontentfiltermodel.cpp \
+         torrentcontentindex.cpp \
          torrentadditiondlg.cpp \
          sessionapplication.cpp \
          torrentimportdlg.cpp \
@@ -178,6 +185,7 @@ SOURCES += mainwindow.cpp \
          transfer_list.cpp \
          status_widget.cpp  \
          search_widget.cpp \
+         search_result_model.cpp \
          search_filter.cpp \
          messages_widget.cpp \
          add_friend.cpp \
@@ -190,7 +198,8 @@ SOURCES += mainwindow.cpp \
          torrent_properties.cpp \
          ed2k_link_maker.cpp \
          delay.cpp \
-         wgetter.cpp
+         wgetter.cpp \
+         torrent_search.cpp
 
   macx {
     HEADERS += qmacapplication.h 
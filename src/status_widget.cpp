@@ -1,6 +1,7 @@
 #include <QDateTime>
 #include <libed2k/util.hpp>
 #include "status_widget.h"
+#include "transport/session_log.h"
 
 status_widget::status_widget(QWidget *parent)
     : QWidget(parent)
@@ -9,6 +10,7 @@ status_widget::status_widget(QWidget *parent)
 
     m_nFiles = 0;
     m_nUsers = 0;
+    m_nConsoleSeen = 0;
 
     setDisconnectedInfo();
 
@@ -33,6 +35,20 @@ void status_widget::addHtmlLogMessage(const QString& msg)
     editJournal->appendHtml(msg);
 }
 
+void status_widget::addConsoleRecords(int journal)
+{
+    if (journal != SessionLog::J_CONSOLE)
+        return;
+
+    // burst longer than ring is shown by its tail only
+    const LogRing& ring = SessionLog::instance()->journal(SessionLog::J_CONSOLE);
+    const int count = static_cast<int>(qMin<quint64>(ring.total() - m_nConsoleSeen, ring.size()));
+    m_nConsoleSeen = ring.total();
+
+    for (int i = ring.size() - count; i < ring.size(); ++i)
+        editJournal->appendHtml(SessionLog::html(ring.at(i)));
+}
+
 void status_widget::setDisconnectedInfo()
 {
     editInfo->clear();
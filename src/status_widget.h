@@ -12,6 +12,7 @@ class status_widget : public QWidget, private Ui::status_widget
     unsigned int m_nClientId;
     int m_nFiles;
     int m_nUsers;
+    quint64 m_nConsoleSeen;
 
 public:
     status_widget(QWidget *parent = 0);
@@ -25,6 +26,7 @@ public:
     void clientID(unsigned int nClientId);
 public slots:
     void addHtmlLogMessage(const QString& msg);
+    void addConsoleRecords(int journal);
 };
 
 #endif // STATUS_WIDGET_H
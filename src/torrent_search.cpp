@@ -0,0 +1,474 @@
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QStringList>
+#include <QTextCodec>
+#include <QtConcurrentRun>
+#include <QDebug>
+
+#include "torrent_search.h"
+
+namespace
+{
+    const int max_redirects = 5;
+
+    enum Field
+    {
+        F_NONE,
+        F_HEAD,     // table header, has no result rows
+        F_TEXT,
+        F_NAME,
+        F_MAGNET,
+        F_TYPE,
+        F_SIZE,
+        F_SEEDERS,
+        F_LEECHERS,
+        F_SITE,
+        F_NUM
+    };
+
+    struct Frame
+    {
+        QString tag;
+        int     field;  // cell of result row which has this element
+    };
+
+    bool isVoid(const QString& tag)
+    {
+        static const char* tags[] = { "area", "base", "br", "col", "embed", "hr", "img", "input",
+                                      "link", "meta", "param", "source", "wbr" };
+
+        for (size_t i = 0; i < sizeof(tags)/sizeof(tags[0]); ++i)
+            if (tag == QLatin1String(tags[i])) return true;
+
+        return false;
+    }
+
+    int divField(const QString& classes)
+    {
+        foreach(const QString& cls, classes.split(QLatin1Char(' '), QString::SkipEmptyParts))
+        {
+            if (cls == QLatin1String("text")) return F_TEXT;
+            if (cls == QLatin1String("magnet")) return F_MAGNET;
+            if (cls == QLatin1String("date")) return F_TYPE;
+            if (cls == QLatin1String("col-3")) return F_SIZE;
+            if (cls == QLatin1String("col-4")) return F_SEEDERS;
+            if (cls == QLatin1String("col-5")) return F_LEECHERS;
+            if (cls == QLatin1String("col-6")) return F_SITE;
+        }
+
+        return F_NONE;
+    }
+
+    void appendRow(QList<TorrentSearchRow>& rows, TorrentSearchRow& row, const QString* texts)
+    {
+        row.m_name = texts[F_NAME].simplified();
+        row.m_type = texts[F_TYPE].simplified();
+        row.m_size = parseTorrentSize(texts[F_SIZE].simplified());
+        row.m_seeders = texts[F_SEEDERS].simplified().toInt();
+        row.m_leechers = texts[F_LEECHERS].simplified().toInt();
+        rows << row;
+    }
+}
+
+HtmlTokenizer::HtmlTokenizer(const QString& html) : m_html(html), m_pos(0), m_self_closing(false)
+{
+}
+
+HtmlTokenizer::Token HtmlTokenizer::next()
+{
+    m_name.clear();
+    m_text.clear();
+    m_attributes.clear();
+    m_self_closing = false;
+
+    if (!m_raw_end.isEmpty())
+    {
+        int end = m_html.indexOf(QString(QLatin1String("</") + m_raw_end), m_pos, Qt::CaseInsensitive);
+        m_pos = (end < 0) ? m_html.size() : end;
+        m_raw_end.clear();
+    }
+
+    while (m_pos < m_html.size())
+    {
+        if (m_html.at(m_pos) != QLatin1Char('<'))
+        {
+            int end = m_html.indexOf(QLatin1Char('<'), m_pos);
+            if (end < 0) end = m_html.size();
+            m_text = decodeEntities(m_html.mid(m_pos, end - m_pos));
+            m_pos = end;
+            return T_TEXT;
+        }
+
+        if (m_html.midRef(m_pos, 4) == QLatin1String("<!--"))
+        {
+            skipTo(QLatin1String("-->"));
+            continue;
+        }
+
+        int pos = m_pos + 1;
+        bool end_tag = (pos < m_html.size() && m_html.at(pos) == QLatin1Char('/'));
+        if (end_tag) ++pos;
+
+        // doctype and processing instructions
+        if (pos < m_html.size() && (m_html.at(pos) == QLatin1Char('!') || m_html.at(pos) == QLatin1Char('?')))
+        {
+            skipTo(QLatin1String(">"));
+            continue;
+        }
+
+        int name_end = pos;
+        while (name_end < m_html.size() &&
+               (m_html.at(name_end).isLetterOrNumber() ||
+                m_html.at(name_end) == QLatin1Char('-') || m_html.at(name_end) == QLatin1Char(':')))
+            ++name_end;
+
+        if (name_end == pos)
+        {
+            // lone '<' is text
+            m_text = QLatin1String("<");
+            ++m_pos;
+            return T_TEXT;
+        }
+
+        m_name = m_html.mid(pos, name_end - pos).toLower();
+        m_pos = name_end;
+        readAttributes();
+
+        if (end_tag) return T_END_TAG;
+
+        if (!m_self_closing && (m_name == QLatin1String("script") || m_name == QLatin1String("style")))
+            m_raw_end = m_name;
+
+        return T_START_TAG;
+    }
+
+    return T_END;
+}
+
+QString HtmlTokenizer::attribute(const QString& name) const
+{
+    for (int i = 0; i < m_attributes.size(); ++i)
+        if (m_attributes.at(i).first == name) return m_attributes.at(i).second;
+
+    return QString();
+}
+
+// static
+QString HtmlTokenizer::decodeEntities(const QString& str)
+{
+    int amp = str.indexOf(QLatin1Char('&'));
+    if (amp < 0) return str;
+
+    QString res;
+    res.reserve(str.size());
+    int pos = 0;
+
+    while (amp >= 0)
+    {
+        res.append(str.midRef(pos, amp - pos));
+        int semi = str.indexOf(QLatin1Char(';'), amp);
+        QString decoded;
+
+        if (semi > amp + 1 && semi - amp <= 10)
+        {
+            QString entity = str.mid(amp + 1, semi - amp - 1);
+
+            if (entity.startsWith(QLatin1Char('#')))
+            {
+                bool ok = false;
+                uint code = (entity.size() > 1 && (entity.at(1) == QLatin1Char('x') || entity.at(1) == QLatin1Char('X'))) ?
+                    entity.mid(2).toUInt(&ok, 16) : entity.mid(1).toUInt(&ok, 10);
+                if (ok && code > 0 && code <= 0x10FFFF) decoded = QString::fromUcs4(&code, 1);
+            }
+            else if (entity == QLatin1String("amp")) decoded = QLatin1String("&");
+            else if (entity == QLatin1String("lt")) decoded = QLatin1String("<");
+            else if (entity == QLatin1String("gt")) decoded = QLatin1String(">");
+            else if (entity == QLatin1String("quot")) decoded = QLatin1String("\"");
+            else if (entity == QLatin1String("apos")) decoded = QLatin1String("'");
+            else if (entity == QLatin1String("nbsp")) decoded = QChar(0xA0);
+        }
+
+        if (decoded.isEmpty())
+        {
+            res.append(QLatin1Char('&'));
+            pos = amp + 1;
+        }
+        else
+        {
+            res.append(decoded);
+            pos = semi + 1;
+        }
+
+        amp = str.indexOf(QLatin1Char('&'), pos);
+    }
+
+    res.append(str.midRef(pos));
+    return res;
+}
+
+void HtmlTokenizer::skipTo(const QString& str)
+{
+    int end = m_html.indexOf(str, m_pos);
+    m_pos = (end < 0) ? m_html.size() : end + str.size();
+}
+
+void HtmlTokenizer::readAttributes()
+{
+    const int size = m_html.size();
+
+    while (m_pos < size)
+    {
+        QChar c = m_html.at(m_pos);
+
+        if (c == QLatin1Char('>'))
+        {
+            ++m_pos;
+            return;
+        }
+
+        if (c.isSpace() || c == QLatin1Char('='))
+        {
+            ++m_pos;
+            continue;
+        }
+
+        if (c == QLatin1Char('/'))
+        {
+            m_self_closing = true;
+            ++m_pos;
+            continue;
+        }
+
+        m_self_closing = false;
+        int start = m_pos;
+
+        while (m_pos < size && !m_html.at(m_pos).isSpace() && m_html.at(m_pos) != QLatin1Char('=') &&
+               m_html.at(m_pos) != QLatin1Char('>') && m_html.at(m_pos) != QLatin1Char('/'))
+            ++m_pos;
+
+        QString name = m_html.mid(start, m_pos - start).toLower();
+        QString value;
+
+        while (m_pos < size && m_html.at(m_pos).isSpace()) ++m_pos;
+
+        if (m_pos < size && m_html.at(m_pos) == QLatin1Char('='))
+        {
+            ++m_pos;
+            while (m_pos < size && m_html.at(m_pos).isSpace()) ++m_pos;
+
+            if (m_pos < size && (m_html.at(m_pos) == QLatin1Char('"') || m_html.at(m_pos) == QLatin1Char('\'')))
+            {
+                QChar quote = m_html.at(m_pos++);
+                int end = m_html.indexOf(quote, m_pos);
+                if (end < 0) end = size;
+                value = m_html.mid(m_pos, end - m_pos);
+                m_pos = qMin(end + 1, size);
+            }
+            else
+            {
+                start = m_pos;
+                while (m_pos < size && !m_html.at(m_pos).isSpace() && m_html.at(m_pos) != QLatin1Char('>'))
+                    ++m_pos;
+                value = m_html.mid(start, m_pos - start);
+            }
+        }
+
+        m_attributes.append(qMakePair(name, decodeEntities(value)));
+    }
+}
+
+QList<TorrentSearchRow> parseTorrtillaPage(const QByteArray& page, const QUrl& base)
+{
+    QList<TorrentSearchRow> rows;
+    QTextCodec* codec = QTextCodec::codecForHtml(page, QTextCodec::codecForName("UTF-8"));
+    HtmlTokenizer tokenizer(codec->toUnicode(page));
+
+    QVector<Frame> stack;
+    int table = -1; // stack size with results table open
+    int row = -1;   // stack size with result row open
+    TorrentSearchRow current;
+    bool has_name = false;
+    QString texts[F_NUM];
+
+    for (HtmlTokenizer::Token token = tokenizer.next(); token != HtmlTokenizer::T_END; token = tokenizer.next())
+    {
+        if (token == HtmlTokenizer::T_TEXT)
+        {
+            if (row >= 0 && stack.last().field != F_NONE && stack.last().field != F_HEAD)
+                texts[stack.last().field] += tokenizer.text();
+            continue;
+        }
+
+        const QString& tag = tokenizer.name();
+
+        // row is finished by its end tag, next row or end of table
+        bool close_row = (row >= 0 && tag == QLatin1String("tr"));
+
+        if (token == HtmlTokenizer::T_END_TAG || close_row)
+        {
+            int pos = close_row ? row - 1 : stack.size() - 1;
+            while (pos >= 0 && stack.at(pos).tag != tag) --pos;
+            if (pos >= 0) stack.resize(pos);
+
+            if (row >= 0 && stack.size() < row)
+            {
+                if (has_name) appendRow(rows, current, texts);
+                row = -1;
+            }
+
+            // only first results table is parsed
+            if (table >= 0 && stack.size() < table) break;
+            if (token == HtmlTokenizer::T_END_TAG) continue;
+        }
+
+        Frame frame;
+        frame.tag = tag;
+        frame.field = stack.isEmpty() ? int(F_NONE) : stack.last().field;
+        bool open_table = false;
+        bool open_row = false;
+
+        if (table < 0)
+        {
+            open_table = (tag == QLatin1String("table") && tokenizer.attribute(QLatin1String("id")) == QLatin1String("res_table"));
+        }
+        else if (row < 0)
+        {
+            if (tag == QLatin1String("thead"))
+                frame.field = F_HEAD;
+            else if (tag == QLatin1String("tr") && frame.field != F_HEAD)
+                open_row = true;
+        }
+        else if (tag == QLatin1String("div"))
+        {
+            int field = divField(tokenizer.attribute(QLatin1String("class")));
+            if (field != F_NONE) frame.field = field;
+        }
+        else if (tag == QLatin1String("a") && frame.field == F_TEXT && !has_name)
+        {
+            frame.field = F_NAME;
+            current.m_url = base.resolved(QUrl(tokenizer.attribute(QLatin1String("href")))).toString();
+            has_name = true;
+        }
+        else if (tag == QLatin1String("a") && frame.field == F_MAGNET && current.m_magnet.isEmpty())
+        {
+            current.m_magnet = tokenizer.attribute(QLatin1String("href"));
+        }
+        else if (tag == QLatin1String("span") && frame.field == F_SITE && current.m_site.isEmpty())
+        {
+            current.m_site = tokenizer.attribute(QLatin1String("title"));
+        }
+
+        if (tokenizer.selfClosing() || isVoid(tag)) continue;
+
+        stack.push_back(frame);
+
+        if (open_table) table = stack.size();
+
+        if (open_row)
+        {
+            row = stack.size();
+            current = TorrentSearchRow();
+            has_name = false;
+            for (int i = 0; i < F_NUM; ++i) texts[i].clear();
+        }
+    }
+
+    // page was cut inside of row
+    if (row >= 0 && has_name) appendRow(rows, current, texts);
+
+    return rows;
+}
+
+qulonglong parseTorrentSize(const QString& str)
+{
+    QStringList lst = str.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    double base = 0;
+    qulonglong mes = 1;
+
+    if (lst.size() == 2)
+    {
+        base = lst[0].toDouble();
+
+        if (lst[1] == QLatin1String("KB")) mes = 1000;
+        else if (lst[1] == QLatin1String("MB")) mes = 1000 * 1000;
+        else if (lst[1] == QLatin1String("GB")) mes = 1000 * 1000 * 1000;
+        else mes = 0;
+    }
+
+    return base * mes;
+}
+
+TorrtillaSearch::TorrtillaSearch(const QString& base_url /*= QString("http://torrtilla.ru/torrents/0/")*/,
+                                 QObject* parent /*= 0*/) :
+    TorrentSearchProvider(parent), m_base_url(base_url), m_reply(NULL), m_redirects(0), m_parsing(false)
+{
+    connect(&m_parser, SIGNAL(finished()), SLOT(on_parseFinished()));
+}
+
+TorrtillaSearch::~TorrtillaSearch()
+{
+    cancel();
+    m_parser.waitForFinished();
+}
+
+void TorrtillaSearch::search(const QString& request)
+{
+    cancel();
+    m_redirects = 0;
+    get(QUrl(m_base_url + request));
+}
+
+void TorrtillaSearch::cancel()
+{
+    m_parsing = false;
+
+    if (m_reply)
+    {
+        m_reply->disconnect(this);
+        m_reply->abort();
+        m_reply->deleteLater();
+        m_reply = NULL;
+    }
+}
+
+void TorrtillaSearch::get(const QUrl& url)
+{
+    m_reply = m_nm.get(QNetworkRequest(url));
+    connect(m_reply, SIGNAL(finished()), SLOT(on_replyFinished()));
+}
+
+void TorrtillaSearch::on_replyFinished()
+{
+    QNetworkReply* reply = m_reply;
+    m_reply = NULL;
+    reply->deleteLater();
+
+    QUrl redirect = reply->attribute(QNetworkRequest::RedirectionTargetAttribute).toUrl();
+
+    if (reply->error() == QNetworkReply::NoError && redirect.isValid() && m_redirects < max_redirects)
+    {
+        ++m_redirects;
+        get(reply->url().resolved(redirect));
+        return;
+    }
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        qDebug() << "torrent search failed: " << reply->errorString();
+        emit finished(false, QList<TorrentSearchRow>());
+        return;
+    }
+
+    // page is parsed on worker thread, it holds own copy of data
+    m_parsing = true;
+    m_parser.setFuture(QtConcurrent::run(parseTorrtillaPage, reply->readAll(), reply->url()));
+}
+
+void TorrtillaSearch::on_parseFinished()
+{
+    // search was cancelled or replaced while page was parsed
+    if (!m_parsing) return;
+
+    m_parsing = false;
+    emit finished(true, m_parser.result());
+}
@@ -0,0 +1,125 @@
+#ifndef __TORRENT_SEARCH__
+#define __TORRENT_SEARCH__
+
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QUrl>
+#include <QVector>
+#include <QFutureWatcher>
+#include <QNetworkAccessManager>
+
+class QNetworkReply;
+
+/**
+  * one row of torrent search results page
+ */
+struct TorrentSearchRow
+{
+    TorrentSearchRow() : m_size(0), m_seeders(0), m_leechers(0) {}
+
+    QString     m_name;
+    QString     m_url;      // absolute url of torrent page
+    QString     m_magnet;
+    QString     m_type;
+    qulonglong  m_size;
+    int         m_seeders;
+    int         m_leechers;
+    QString     m_site;     // tracker site which has torrent
+};
+
+/**
+  * torrent search service, one request at a time
+  * finished comes once for each search which wasn't cancelled
+ */
+class TorrentSearchProvider : public QObject
+{
+    Q_OBJECT
+public:
+    TorrentSearchProvider(QObject* parent = 0) : QObject(parent) {}
+    virtual ~TorrentSearchProvider() {}
+
+    virtual void search(const QString& request) = 0;
+    virtual void cancel() = 0;
+signals:
+    void finished(bool ok, const QList<TorrentSearchRow>& rows);
+};
+
+/**
+  * splits html into tags and text without building document
+  * text and attribute values come with entities decoded, script and style content is skipped
+ */
+class HtmlTokenizer
+{
+public:
+    enum Token
+    {
+        T_END,
+        T_START_TAG,
+        T_END_TAG,
+        T_TEXT
+    };
+
+    HtmlTokenizer(const QString& html);
+    Token next();
+
+    /**
+      * lowercase name of current tag
+     */
+    const QString& name() const { return m_name; }
+    const QString& text() const { return m_text; }
+    QString attribute(const QString& name) const;
+    bool selfClosing() const { return m_self_closing; }
+
+    static QString decodeEntities(const QString& str);
+private:
+    void skipTo(const QString& str);
+    void readAttributes();
+
+    const QString   m_html;
+    int             m_pos;
+    QString         m_name;
+    QString         m_text;
+    QString         m_raw_end;  // script or style is open
+    bool            m_self_closing;
+    QVector<QPair<QString, QString> > m_attributes;
+};
+
+/**
+  * rows of results table of torrtilla.ru page, links are resolved against base
+ */
+QList<TorrentSearchRow> parseTorrtillaPage(const QByteArray& page, const QUrl& base);
+
+/**
+  * parses sizes like '500 MB', '1.6 GB', returns 0 on fail
+ */
+qulonglong parseTorrentSize(const QString& str);
+
+/**
+  * searches torrtilla.ru, page is downloaded by network manager and parsed on worker thread
+ */
+class TorrtillaSearch : public TorrentSearchProvider
+{
+    Q_OBJECT
+public:
+    TorrtillaSearch(const QString& base_url = QString("http://torrtilla.ru/torrents/0/"), QObject* parent = 0);
+    ~TorrtillaSearch();
+
+    void search(const QString& request);
+    void cancel();
+private slots:
+    void on_replyFinished();
+    void on_parseFinished();
+private:
+    void get(const QUrl& url);
+
+    QString                 m_base_url;
+    QNetworkAccessManager   m_nm;
+    QNetworkReply*          m_reply;
+    int                     m_redirects;
+    QFutureWatcher<QList<TorrentSearchRow> > m_parser;
+    bool                    m_parsing;  // parser result is expected
+};
+
+#endif //__TORRENT_SEARCH__
@@ -81,7 +81,7 @@ torrentAdditionDialog::torrentAdditionDialog(QWidget *parent) :
   connect(comboLabel, SIGNAL(editTextChanged(QString)), this, SLOT(updateLabelInSavePath(QString)));
   connect(comboLabel, SIGNAL(currentIndexChanged(QString)), this, SLOT(updateLabelInSavePath(QString)));
   LineEdit *contentFilterLine = new LineEdit(this);
-  connect(contentFilterLine, SIGNAL(textChanged(QString)), PropListModel, SLOT(setFilterFixedString(QString)));
+  connect(contentFilterLine, SIGNAL(textChanged(QString)), PropListModel, SLOT(setNameFilter(QString)));
   contentFilterLayout->insertWidget(1, contentFilterLine);
   // Important: as a default, it inserts at the bottom which is not desirable
   savePathTxt->setInsertPolicy(QComboBox::InsertAtCurrent);
@@ -37,9 +37,6 @@ TorrentContentFilterModel::TorrentContentFilterModel(QObject *parent):
   connect(m_model, SIGNAL(filteredFilesChanged()), this, SIGNAL(filteredFilesChanged()));
   setSourceModel(m_model);
   // Filter settings
-  setFilterCaseSensitivity(Qt::CaseInsensitive);
-  setFilterKeyColumn(TorrentContentModelItem::COL_NAME);
-  setFilterRole(Qt::DisplayRole);
   setDynamicSortFilter(true);
   setSortCaseSensitivity(Qt::CaseInsensitive);
 }
@@ -74,11 +71,13 @@ QModelIndex TorrentContentFilterModel::parent(const QModelIndex& child) const
 
 bool TorrentContentFilterModel::filterAcceptsRow(int source_row, const QModelIndex& source_parent) const
 {
-  if (m_model->getType(m_model->index(source_row, 0, source_parent)) == TorrentContentModelItem::FOLDER) {
-    // always accept folders, since we want to filter their children
-    return true;
-  }
-  return QSortFilterProxyModel::filterAcceptsRow(source_row, source_parent);
+  return m_model->nameFilterAccepts(m_model->index(source_row, 0, source_parent));
+}
+
+void TorrentContentFilterModel::setNameFilter(const QString& pattern)
+{
+  m_model->setNameFilter(pattern);
+  invalidateFilter();
 }
 
 void TorrentContentFilterModel::selectAll()
@@ -57,6 +57,8 @@ protected:
 public slots:
   void selectAll();
   void selectNone();
+  // replaces regexp filtering, rows are looked up in name index of content model
+  void setNameFilter(const QString& pattern);
 
 private:
   TorrentContentModel *m_model;
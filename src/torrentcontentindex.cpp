@@ -0,0 +1,187 @@
+#include "torrentcontentindex.h"
+#include "torrentcontentmodelitem.h"
+#include <algorithm>
+
+namespace {
+
+inline quint64 trigram(const QString &s, int pos)
+{
+  return (quint64(s.at(pos).unicode()) << 32) | (quint64(s.at(pos + 1).unicode()) << 16) | s.at(pos + 2).unicode();
+}
+
+}
+
+TorrentContentIndex::TorrentContentIndex()
+{
+}
+
+void TorrentContentIndex::build(const QVector<TorrentContentModelItem*> &files)
+{
+  clear();
+  m_files = files;
+  m_names.resize(files.size());
+  m_matched.fill(false, files.size());
+
+  for (int i=0; i<files.size(); ++i) {
+    m_names[i] = files.at(i)->getName().toLower();
+    addTrigrams(i);
+  }
+
+  // keep pattern of previous torrent, filter line still shows it
+  if (isActive())
+    match();
+}
+
+void TorrentContentIndex::clear()
+{
+  m_files.clear();
+  m_names.clear();
+  m_trigrams.clear();
+  m_matched.clear();
+  m_matches.clear();
+  m_folderHits.clear();
+}
+
+void TorrentContentIndex::rename(int file_index)
+{
+  Q_ASSERT(file_index >= 0 && file_index < m_files.size());
+  removeTrigrams(file_index);
+  m_names[file_index] = m_files.at(file_index)->getName().toLower();
+  addTrigrams(file_index);
+
+  if (!isActive()) return;
+  const bool matched = m_names.at(file_index).contains(m_pattern);
+  if (matched == m_matched.at(file_index)) return;
+  setMatched(file_index, matched);
+  if (matched)
+    m_matches.append(file_index);
+  else
+    m_matches.remove(m_matches.indexOf(file_index));
+}
+
+void TorrentContentIndex::setPattern(const QString &pattern)
+{
+  const QString lower = pattern.toLower();
+  if (lower == m_pattern) return;
+
+  const QString previous = m_pattern;
+  m_pattern = lower;
+
+  if (!isActive()) {
+    resetMatches();
+    return;
+  }
+
+  if (!previous.isEmpty() && m_pattern.contains(previous)) {
+    // longer pattern matches subset of previous matches
+    QVector<int> matches;
+    matches.reserve(m_matches.size());
+    foreach (int i, m_matches) {
+      if (m_names.at(i).contains(m_pattern))
+        matches.append(i);
+      else
+        setMatched(i, false);
+    }
+    m_matches = matches;
+    return;
+  }
+
+  resetMatches();
+  match();
+}
+
+bool TorrentContentIndex::accepts(const TorrentContentModelItem *item) const
+{
+  if (!isActive()) return true;
+  switch (item->getType()) {
+  case TorrentContentModelItem::TFILE:
+    return m_matched.value(item->getFileIndex(), false);
+  case TorrentContentModelItem::FOLDER:
+    return m_folderHits.value(item, 0) > 0;
+  default:
+    return true;
+  }
+}
+
+void TorrentContentIndex::addTrigrams(int file_index)
+{
+  const QString &name = m_names.at(file_index);
+  for (int pos=0; pos+2<name.size(); ++pos) {
+    QVector<int> &list = m_trigrams[trigram(name, pos)];
+    QVector<int>::iterator it = std::lower_bound(list.begin(), list.end(), file_index);
+    // same trigram may repeat in one name
+    if (it == list.end() || *it != file_index)
+      list.insert(it, file_index);
+  }
+}
+
+void TorrentContentIndex::removeTrigrams(int file_index)
+{
+  const QString &name = m_names.at(file_index);
+  for (int pos=0; pos+2<name.size(); ++pos) {
+    QHash<quint64, QVector<int> >::iterator hit = m_trigrams.find(trigram(name, pos));
+    if (hit == m_trigrams.end()) continue;
+    QVector<int>::iterator it = std::lower_bound(hit->begin(), hit->end(), file_index);
+    if (it != hit->end() && *it == file_index)
+      hit->erase(it);
+    if (hit->isEmpty())
+      m_trigrams.erase(hit);
+  }
+}
+
+void TorrentContentIndex::setMatched(int file_index, bool matched)
+{
+  m_matched[file_index] = matched;
+  const int delta = matched ? 1 : -1;
+  // every ancestor folder counts matched files below it
+  for (TorrentContentModelItem *folder = m_files.at(file_index)->parent();
+       folder && folder->getType() == TorrentContentModelItem::FOLDER; folder = folder->parent()) {
+    QHash<const TorrentContentModelItem*, int>::iterator it = m_folderHits.find(folder);
+    if (it == m_folderHits.end())
+      it = m_folderHits.insert(folder, 0);
+    *it += delta;
+    if (*it == 0)
+      m_folderHits.erase(it);
+  }
+}
+
+void TorrentContentIndex::resetMatches()
+{
+  foreach (int i, m_matches)
+    m_matched[i] = false;
+  m_matches.clear();
+  m_folderHits.clear();
+}
+
+void TorrentContentIndex::match()
+{
+  Q_ASSERT(m_matches.isEmpty());
+
+  if (m_pattern.size() < 3) {
+    // too short for trigrams, names are scanned
+    for (int i=0; i<m_names.size(); ++i) {
+      if (m_names.at(i).contains(m_pattern)) {
+        m_matches.append(i);
+        setMatched(i, true);
+      }
+    }
+    return;
+  }
+
+  // candidates are files of the rarest trigram of pattern
+  const QVector<int> *candidates = 0;
+  for (int pos=0; pos+2<m_pattern.size(); ++pos) {
+    QHash<quint64, QVector<int> >::const_iterator it = m_trigrams.constFind(trigram(m_pattern, pos));
+    if (it == m_trigrams.constEnd())
+      return;
+    if (!candidates || it->size() < candidates->size())
+      candidates = &(*it);
+  }
+
+  foreach (int i, *candidates) {
+    if (m_names.at(i).contains(m_pattern)) {
+      m_matches.append(i);
+      setMatched(i, true);
+    }
+  }
+}
@@ -0,0 +1,44 @@
+#ifndef TORRENTCONTENTINDEX_H
+#define TORRENTCONTENTINDEX_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+class TorrentContentModelItem;
+
+// Lowercase trigram index over file names of one torrent, built with the content model
+// Keeps files matching current pattern and number of matching files under each folder,
+// so folders are accepted exactly when some file below them matches
+class TorrentContentIndex {
+public:
+  TorrentContentIndex();
+
+  // files are indexed by libtorrent file index
+  void build(const QVector<TorrentContentModelItem*> &files);
+  void clear();
+  // name of file was changed
+  void rename(int file_index);
+
+  // substring match, case insensitive, empty pattern accepts everything
+  void setPattern(const QString &pattern);
+  bool isActive() const { return !m_pattern.isEmpty(); }
+  bool accepts(const TorrentContentModelItem *item) const;
+
+private:
+  void addTrigrams(int file_index);
+  void removeTrigrams(int file_index);
+  void setMatched(int file_index, bool matched);
+  void resetMatches();
+  void match();
+
+  QVector<TorrentContentModelItem*> m_files;
+  QVector<QString> m_names; // lowercase names
+  QHash<quint64, QVector<int> > m_trigrams; // sorted file indexes for every trigram
+  QString m_pattern;
+  QVector<bool> m_matched;
+  QVector<int> m_matches; // matched file indexes, narrowed while pattern grows
+  QHash<const TorrentContentModelItem*, int> m_folderHits;
+};
+
+#endif // TORRENTCONTENTINDEX_H
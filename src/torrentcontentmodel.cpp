@@ -33,6 +33,7 @@
 #include "torrentcontentmodel.h"
 #include "torrentcontentmodelitem.h"
 #include <QDir>
+#include <QHash>
 
 TorrentContentModel::TorrentContentModel(QObject *parent):
   QAbstractItemModel(parent),
@@ -48,21 +49,43 @@ TorrentContentModel::~TorrentContentModel()
 
 void TorrentContentModel::updateFilesProgress(const std::vector<libtorrent::size_type>& fp)
 {
-  emit layoutAboutToBeChanged();
   Q_ASSERT(m_filesIndex.size() == (int)fp.size());
   for (uint i=0; i<fp.size(); ++i) {
-    m_filesIndex[i]->setProgress(fp[i]);
+    m_filesIndex[i]->setFileProgress(fp[i]);
   }
-  emit dataChanged(index(0,0), index(rowCount(), columnCount()));
+  m_rootItem->aggregate();
+  notifyChanged(m_rootItem, QModelIndex());
 }
 
 void TorrentContentModel::updateFilesPriorities(const std::vector<int> &fprio)
 {
-  emit layoutAboutToBeChanged();
+  Q_ASSERT(m_filesIndex.size() >= (int)fprio.size());
   for (uint i=0; i<fprio.size(); ++i) {
-    m_filesIndex[i]->setPriority(fprio[i]);
+    m_filesIndex[i]->setFilePriority(fprio[i]);
   }
-  emit dataChanged(index(0,0), index(rowCount(), columnCount()));
+  m_rootItem->aggregate();
+  notifyChanged(m_rootItem, QModelIndex());
+}
+
+void TorrentContentModel::notifyChanged(TorrentContentModelItem *parentItem, const QModelIndex &parentIndex, bool notify)
+{
+  const QList<TorrentContentModelItem*>& children = parentItem->children();
+  int first = -1;
+  for (int row=0; row<children.size(); ++row) {
+    TorrentContentModelItem *child = children.at(row);
+    if (child->takeChanged()) {
+      if (first < 0)
+        first = row;
+    } else if (first >= 0) {
+      if (notify)
+        emit dataChanged(index(first, 0, parentIndex), index(row - 1, TorrentContentModelItem::NB_COL - 1, parentIndex));
+      first = -1;
+    }
+    if (child->isFolder())
+      notifyChanged(child, index(row, 0, parentIndex), notify);
+  }
+  if (first >= 0 && notify)
+    emit dataChanged(index(first, 0, parentIndex), index(children.size() - 1, TorrentContentModelItem::NB_COL - 1, parentIndex));
 }
 
 std::vector<int> TorrentContentModel::getFilesPriorities(unsigned int nbFiles) const
@@ -117,6 +140,8 @@ bool TorrentContentModel::setData(const QModelIndex& index, const QVariant& valu
     switch(index.column()) {
     case TorrentContentModelItem::COL_NAME:
       item->setName(value.toString());
+      if (item->getType() == TorrentContentModelItem::TFILE)
+        m_nameIndex.rename(item->getFileIndex());
       break;
     case TorrentContentModelItem::COL_SIZE:
       item->setSize(value.toULongLong());
@@ -253,6 +278,7 @@ void TorrentContentModel::clear()
   qDebug("clear called");
   beginResetModel();
   m_filesIndex.clear();
+  m_nameIndex.clear();
   m_rootItem->deleteAllChildren();
   endResetModel();
 }
@@ -263,19 +289,18 @@ void TorrentContentModel::setupModelData(const libtorrent::torrent_info &t)
   if (t.num_files() == 0)
     return;
 
-  emit layoutAboutToBeChanged();
+  beginResetModel();
   // Initialize files_index array
   qDebug("Torrent contains %d files", t.num_files());
   m_filesIndex.reserve(t.num_files());
 
-  TorrentContentModelItem *parent = m_rootItem;
-  TorrentContentModelItem *root_folder = parent;
-  TorrentContentModelItem *current_parent;
+  // Folders by relative path, tree is built unsorted and sorted once at the end
+  QHash<QString, TorrentContentModelItem*> folders;
 
   // Iterate over files
   for (int i=0; i<t.num_files(); ++i) {
     libtorrent::file_entry fentry = t.file_at(i);
-    current_parent = root_folder;
+    TorrentContentModelItem *current_parent = m_rootItem;
 #if LIBTORRENT_VERSION_MINOR >= 16
     QString path = QDir::cleanPath(misc::toQStringU(fentry.path)).replace("\\", "/");
 #else
@@ -285,8 +310,10 @@ void TorrentContentModel::setupModelData(const libtorrent::torrent_info &t)
     QStringList pathFolders = path.split("/");
     pathFolders.removeAll(".unwanted");
     pathFolders.takeLast();
+    QString folderPath;
     foreach (const QString &pathPart, pathFolders) {
-      TorrentContentModelItem *new_parent = current_parent->childWithName(pathPart);
+      folderPath += pathPart + "/";
+      TorrentContentModelItem *&new_parent = folders[folderPath];
       if (!new_parent) {
         new_parent = new TorrentContentModelItem(pathPart, current_parent);
       }
@@ -295,7 +322,25 @@ void TorrentContentModel::setupModelData(const libtorrent::torrent_info &t)
     // Actually create the file
     m_filesIndex.push_back(new TorrentContentModelItem(t, fentry, current_parent, i));
   }
-  emit layoutChanged();
+
+  m_rootItem->sortChildren();
+  m_rootItem->aggregate();
+  m_nameIndex.build(m_filesIndex);
+  // views are reset, only drop changed marks
+  notifyChanged(m_rootItem, QModelIndex(), false);
+  endResetModel();
+}
+
+void TorrentContentModel::setNameFilter(const QString& pattern)
+{
+  m_nameIndex.setPattern(pattern);
+}
+
+bool TorrentContentModel::nameFilterAccepts(const QModelIndex& index) const
+{
+  if (!index.isValid())
+    return true;
+  return m_nameIndex.accepts(static_cast<const TorrentContentModelItem*>(index.internalPointer()));
 }
 
 void TorrentContentModel::selectAll()
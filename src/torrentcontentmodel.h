@@ -37,6 +37,7 @@
 #include <QVariant>
 #include <libtorrent/torrent_info.hpp>
 #include "torrentcontentmodelitem.h"
+#include "torrentcontentindex.h"
 
 class TorrentContentModel:  public QAbstractItemModel {
   Q_OBJECT
@@ -61,6 +62,9 @@ public:
   virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
   void clear();
   void setupModelData(const libtorrent::torrent_info& t);
+  // file name filter, folders pass when some file below them passes
+  void setNameFilter(const QString& pattern);
+  bool nameFilterAccepts(const QModelIndex& index) const;
 
 signals:
   void filteredFilesChanged();
@@ -70,8 +74,12 @@ public slots:
   void selectNone();
 
 private:
+  // clears changed marks in subtree, emits dataChanged for contiguous ranges of changed rows
+  void notifyChanged(TorrentContentModelItem *parentItem, const QModelIndex &parentIndex, bool notify = true);
+
   TorrentContentModelItem *m_rootItem;
   QVector<TorrentContentModelItem *> m_filesIndex;
+  TorrentContentIndex m_nameIndex;
 };
 
 #endif // TORRENTCONTENTMODEL_H
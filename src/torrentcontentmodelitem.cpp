@@ -31,12 +31,60 @@
 #include "misc.h"
 #include "torrentcontentmodelitem.h"
 #include <QDebug>
+#include <QVector>
+#include <algorithm>
+
+#if defined(Q_WS_WIN)
+#include <qt_windows.h>
+#elif !defined(Q_WS_MAC)
+#include <cstring>
+#endif
+
+namespace {
+
+// Sort key giving same order as QString::localeAwareCompare()
+// on platforms where Qt compares by system collation
+QByteArray collationKey(const QString &name)
+{
+#if defined(Q_WS_WIN)
+  const wchar_t *src = reinterpret_cast<const wchar_t*>(name.utf16());
+  const int len = LCMapStringW(GetUserDefaultLCID(), LCMAP_SORTKEY, src, name.size(), 0, 0);
+  QByteArray key(len, 0);
+  LCMapStringW(GetUserDefaultLCID(), LCMAP_SORTKEY, src, name.size(), reinterpret_cast<wchar_t*>(key.data()), len);
+  return key;
+#elif !defined(Q_WS_MAC)
+  const QByteArray local = name.toLocal8Bit();
+  QByteArray key(int(strxfrm(0, local.constData(), 0)) + 1, 0);
+  strxfrm(key.data(), local.constData(), key.size());
+  key.chop(1);
+  return key;
+#else
+  Q_UNUSED(name);
+  return QByteArray();
+#endif
+}
+
+struct SortEntry {
+  QByteArray key;
+  TorrentContentModelItem *item;
+};
+
+bool sortEntryLess(const SortEntry &e1, const SortEntry &e2)
+{
+#if defined(Q_WS_MAC)
+  return QString::localeAwareCompare(e1.item->getName(), e2.item->getName()) < 0;
+#else
+  return e1.key < e2.key;
+#endif
+}
+
+}
 
 TorrentContentModelItem::TorrentContentModelItem(const libtorrent::torrent_info &t,
                                  const libtorrent::file_entry &f,
                                  TorrentContentModelItem *parent,
                                  int file_index):
-  m_parentItem(parent), m_type(TFILE), m_fileIndex(file_index), m_totalDone(0)
+  m_parentItem(parent), m_type(TFILE), m_fileIndex(file_index), m_totalDone(0), m_changed(false)
 {
   Q_ASSERT(parent);
 
@@ -55,13 +103,12 @@ TorrentContentModelItem::TorrentContentModelItem(const libtorrent::torrent_info
              << 0.
              << prio::NORMAL;
 
-  /* Update parent */
+  /* Update parent, folder sizes are computed by aggregate() */
   m_parentItem->appendChild(this);
-  m_parentItem->updateSize();
 }
 
 TorrentContentModelItem::TorrentContentModelItem(QString name, TorrentContentModelItem *parent):
-  m_parentItem(parent), m_type(FOLDER), m_totalDone(0)
+  m_parentItem(parent), m_type(FOLDER), m_totalDone(0), m_changed(false)
 {
   // Do not display incomplete extensions
   if (name.endsWith(".!qB"))
@@ -76,7 +123,7 @@ TorrentContentModelItem::TorrentContentModelItem(QString name, TorrentContentMod
 }
 
 TorrentContentModelItem::TorrentContentModelItem(const QList<QVariant>& data):
-  m_parentItem(0), m_type(ROOT), m_itemData(data), m_totalDone(0)
+  m_parentItem(0), m_type(ROOT), m_itemData(data), m_totalDone(0), m_changed(false)
 {
   Q_ASSERT(data.size() == 4);
 }
@@ -186,7 +233,7 @@ void TorrentContentModelItem::updateProgress()
   Q_ASSERT(m_type == FOLDER);
   m_totalDone = 0;
   foreach (TorrentContentModelItem* child, m_childItems) {
-    if (child->getPriority() > 0)
+    if (child->getPriority() != prio::IGNORED)
       m_totalDone += child->getTotalDone();
   }
   //qDebug("Folder: total_done: %llu/%llu", total_done, getSize());
@@ -257,6 +304,73 @@ void TorrentContentModelItem::updatePriority()
     setPriority(prio);
 }
 
+void TorrentContentModelItem::setFileProgress(qulonglong done)
+{
+  Q_ASSERT(m_type == TFILE);
+  if (getPriority() == prio::IGNORED || m_totalDone == done) return;
+  Q_ASSERT(done <= getSize());
+  m_totalDone = done;
+  m_changed = true;
+}
+
+void TorrentContentModelItem::setFilePriority(int new_prio)
+{
+  Q_ASSERT(m_type == TFILE);
+  if (getPriority() == new_prio) return;
+  // Reset progress if priority is 0
+  if (new_prio == prio::IGNORED)
+    m_totalDone = 0;
+  m_itemData.replace(COL_PRIO, new_prio);
+  m_changed = true;
+}
+
+// Post-order pass: folder size and progress are sums over not ignored
+// children, priority is common priority of children or PARTIAL
+void TorrentContentModelItem::aggregate()
+{
+  Q_ASSERT(m_type != TFILE);
+  if (m_childItems.isEmpty()) return;
+
+  qulonglong size = 0;
+  qulonglong done = 0;
+  int prio = 0;
+
+  for (int i=0; i<m_childItems.size(); ++i) {
+    TorrentContentModelItem *child = m_childItems.at(i);
+    if (child->m_type == FOLDER)
+      child->aggregate();
+
+    const int child_prio = child->getPriority();
+    if (i == 0)
+      prio = child_prio;
+    else if (child_prio != prio)
+      prio = prio::PARTIAL;
+
+    if (child_prio != prio::IGNORED) {
+      size += child->getSize();
+      done += child->getTotalDone();
+    }
+  }
+
+  // root keeps header titles in its data
+  if (m_type == ROOT) return;
+
+  Q_ASSERT(done <= size);
+  if (getSize() != size || m_totalDone != done || getPriority() != prio) {
+    m_itemData.replace(COL_SIZE, size);
+    m_itemData.replace(COL_PRIO, prio);
+    m_totalDone = done;
+    m_changed = true;
+  }
+}
+
+bool TorrentContentModelItem::takeChanged()
+{
+  const bool changed = m_changed;
+  m_changed = false;
+  return changed;
+}
+
 TorrentContentModelItem* TorrentContentModelItem::childWithName(const QString& name) const
 {
   foreach (TorrentContentModelItem *child, m_childItems) {
@@ -275,13 +389,27 @@ void TorrentContentModelItem::appendChild(TorrentContentModelItem *item)
 {
   Q_ASSERT(item);
   Q_ASSERT(m_type != TFILE);
-  int i=0;
-  for (i=0; i<m_childItems.size(); ++i) {
-    QString newchild_name = item->getName();
-    if (QString::localeAwareCompare(newchild_name, m_childItems.at(i)->getName()) < 0)
-      break;
+  m_childItems.append(item);
+}
+
+void TorrentContentModelItem::sortChildren()
+{
+  Q_ASSERT(m_type != TFILE);
+  // collation keys are computed once per child instead of once per comparison
+  QVector<SortEntry> entries(m_childItems.size());
+  for (int i=0; i<m_childItems.size(); ++i) {
+    TorrentContentModelItem *child = m_childItems.at(i);
+    entries[i].key = collationKey(child->getName());
+    entries[i].item = child;
+    if (child->m_type == FOLDER)
+      child->sortChildren();
   }
-  m_childItems.insert(i, item);
+
+  // stable, equal names keep torrent order
+  std::stable_sort(entries.begin(), entries.end(), sortEntryLess);
+
+  for (int i=0; i<entries.size(); ++i)
+    m_childItems[i] = entries.at(i).item;
 }
 
 TorrentContentModelItem* TorrentContentModelItem::child(int row)
@@ -76,10 +76,20 @@ public:
   void setPriority(int new_prio, bool update_parent=true);
   void updatePriority();
 
+  // Bulk updates: file values are set without touching parents,
+  // then one aggregate() call on root recomputes all folders
+  void setFileProgress(qulonglong done);
+  void setFilePriority(int new_prio);
+  void aggregate();
+  // Changed mark is set by bulk updates and cleared on read
+  bool takeChanged();
+
   TorrentContentModelItem* childWithName(const QString& name) const;
   bool isFolder() const;
 
   void appendChild(TorrentContentModelItem *item);
+  // Sorts whole subtree by name, called once the tree is built
+  void sortChildren();
   TorrentContentModelItem *child(int row);
   int childCount() const;
   int columnCount() const;
@@ -97,6 +107,7 @@ private:
   QList<QVariant> m_itemData;
   int m_fileIndex;
   qulonglong m_totalDone;
+  bool m_changed;
 };
 
 #endif // TORRENTCONTENTMODELITEM_H
@@ -176,6 +176,8 @@ transfer_list::transfer_list(QWidget *parent, MainWindow *mainWindow)
       
     connect(peersList, SIGNAL(sendMessage(const QString&, const libed2k::net_identifier&)), this, SLOT(sendMessageToPeer(const QString&, const libed2k::net_identifier&)));
     connect(peersList, SIGNAL(addFriend(const QString&, const libed2k::net_identifier&)), this, SLOT(addPeerToFriends(const QString&, const libed2k::net_identifier&)));
+    connect(transferList->selectionModel(), SIGNAL(selectionChanged(const QItemSelection&, const QItemSelection&)),
+            this, SLOT(transferSelectionChanged()));
 }
 
 transfer_list::~transfer_list()
@@ -401,6 +403,12 @@ void transfer_list::refreshPeers()
     peersList->loadPeers();
 }
 
+void transfer_list::transferSelectionChanged()
+{
+    // peers of selected transfers only, all active transfers without selection
+    peersList->setSelectedTransfers(transferList->getSelectedTorrentsHashes());
+}
+
 void transfer_list::addPeerToFriends(const QString& user_name, const libed2k::net_identifier& np)
 {
     emit addFriend(user_name, np);
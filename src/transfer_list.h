@@ -80,6 +80,7 @@ private slots:
     void btnBottomClick();
 
     void refreshPeers();
+    void transferSelectionChanged();
     void addPeerToFriends(const QString& user_name, const libed2k::net_identifier& np);
     void sendMessageToPeer(const QString& user_name, const libed2k::net_identifier& np);
 
@@ -42,6 +42,7 @@
 #include <QStandardItemModel>
 #include <QMessageBox>
 #include <QScrollBar>
+#include <QSet>
 
 #include "transferlistdelegate.h"
 #include "transferlistwidget.h"
@@ -176,16 +177,14 @@ class TransferListFiltersWidget: public QFrame {
   Q_OBJECT
 
 private:
-  QHash<QString, int> customLabels;
+  QSet<QString> customLabels;
   StatusFiltersWidget* statusFilters;
   LabelFiltersList* labelFilters;
   QVBoxLayout* vLayout;
   TransferListWidget *transferList;
-  int nb_labeled;
-  int nb_torrents;
 
 public:
-  TransferListFiltersWidget(QWidget *parent, TransferListWidget *transferList): QFrame(parent), transferList(transferList), nb_labeled(0), nb_torrents(0) {
+  TransferListFiltersWidget(QWidget *parent, TransferListWidget *transferList): QFrame(parent), transferList(transferList) {
     // Construct lists
     vLayout = new QVBoxLayout();
     vLayout->setContentsMargins(0, 4, 0, 4);
@@ -221,12 +220,10 @@ public:
 
     // SIGNAL/SLOT
     connect(statusFilters, SIGNAL(currentRowChanged(int)), transferList, SLOT(applyStatusFilter(int)));
-    connect(transferList->getSourceModel(), SIGNAL(dataChanged(QModelIndex,QModelIndex)), SLOT(updateTorrentNumbers()));
-    connect(transferList->getSourceModel(), SIGNAL(torrentAdded(TorrentModelItem*)), SLOT(handleNewTorrent(TorrentModelItem*)));
+    connect(transferList->getSourceModel(), SIGNAL(statusReportChanged()), SLOT(updateTorrentNumbers()));
+    connect(transferList->getSourceModel(), SIGNAL(labelCountChanged(QString)), SLOT(updateLabelCounter(QString)));
     connect(labelFilters, SIGNAL(currentRowChanged(int)), this, SLOT(applyLabelFilter(int)));
     connect(labelFilters, SIGNAL(torrentDropped(int)), this, SLOT(torrentDropped(int)));
-    connect(transferList->getSourceModel(), SIGNAL(torrentAboutToBeRemoved(TorrentModelItem*)), SLOT(torrentAboutToBeDeleted(TorrentModelItem*)));
-    connect(transferList->getSourceModel(), SIGNAL(torrentChangedLabel(TorrentModelItem*,QString,QString)), SLOT(torrentChangedLabel(TorrentModelItem*, QString, QString)));
 
     // Add Label filters
     QListWidgetItem *allLabels = new QListWidgetItem(labelFilters);
@@ -239,6 +236,9 @@ public:
     // Load settings
     loadSettings();
 
+    updateTorrentNumbers();
+    updateStickyLabelCounters();
+
     labelFilters->setCurrentRow(0);
     //labelFilters->selectionModel()->select(labelFilters->model()->index(0,0), QItemSelectionModel::Select);
 
@@ -263,7 +263,7 @@ public:
     settings.beginGroup(QString::fromUtf8("TransferListFilters"));
     settings.setValue("selectedFilterIndex", QVariant(statusFilters->currentRow()));
     //settings.setValue("selectedLabelIndex", QVariant(labelFilters->currentRow()));
-    settings.setValue("customLabels", QVariant(customLabels.keys()));
+    settings.setValue("customLabels", QVariant(QStringList(customLabels.toList())));
   }
 
   void loadSettings() {
@@ -271,10 +271,10 @@ public:
     statusFilters->setCurrentRow(settings.value("TransferListFilters/selectedFilterIndex", 0).toInt());
     const QStringList label_list = Preferences().getTorrentLabels();
     foreach (const QString &label, label_list) {
-      customLabels.insert(label, 0);
+      customLabels.insert(label);
       qDebug("Creating label QListWidgetItem: %s", qPrintable(label));
       QListWidgetItem *newLabel = new QListWidgetItem();
-      newLabel->setText(label + " (0)");
+      newLabel->setText(label + " ("+ QString::number(transferList->getSourceModel()->labelCount(label)) +")");
       newLabel->setData(Qt::DecorationRole, IconProvider::instance()->getIcon("inode-directory"));
       labelFilters->addItem(newLabel);
     }
@@ -304,10 +304,10 @@ protected slots:
     label = misc::toValidFileSystemName(label.trimmed());
     if (label.isEmpty() || customLabels.contains(label)) return;
     QListWidgetItem *newLabel = new QListWidgetItem();
-    newLabel->setText(label + " (0)");
+    newLabel->setText(label + " ("+ QString::number(transferList->getSourceModel()->labelCount(label)) +")");
     newLabel->setData(Qt::DecorationRole, IconProvider::instance()->getIcon("inode-directory"));
     labelFilters->addItem(newLabel);
-    customLabels.insert(label, 0);
+    customLabels.insert(label);
     Preferences().addTorrentLabel(label);
   }
 
@@ -391,82 +391,24 @@ protected slots:
     }
   }
 
-  void torrentChangedLabel(TorrentModelItem *torrentItem, QString old_label, QString new_label) {
-    Q_UNUSED(torrentItem);
-    qDebug("Torrent label changed from %s to %s", qPrintable(old_label), qPrintable(new_label));
-    if (!old_label.isEmpty()) {
-      if (customLabels.contains(old_label)) {
-        const int new_count = customLabels.value(old_label, 0) - 1;
-        Q_ASSERT(new_count >= 0);
-        customLabels.insert(old_label, new_count);
-        const int row = labelFilters->rowFromLabel(old_label);
-        Q_ASSERT(row >= 2);
-        labelFilters->item(row)->setText(old_label + " ("+ QString::number(new_count) +")");
-      }
-      --nb_labeled;
-    }
-    if (!new_label.isEmpty()) {
-      if (!customLabels.contains(new_label))
-        addLabel(new_label);
-      const int new_count = customLabels.value(new_label, 0) + 1;
-      Q_ASSERT(new_count >= 1);
-      customLabels.insert(new_label, new_count);
-      const int row = labelFilters->rowFromLabel(new_label);
-      Q_ASSERT(row >= 2);
-      labelFilters->item(row)->setText(new_label + " ("+ QString::number(new_count) +")");
-      ++nb_labeled;
-    }
-    updateStickyLabelCounters();
-  }
-
-  void handleNewTorrent(TorrentModelItem* torrentItem) {
-    QString label = torrentItem->data(TorrentModelItem::TR_LABEL).toString();
-    qDebug("New torrent was added with label: %s", qPrintable(label));
+  void updateLabelCounter(const QString &label) {
+    const int count = transferList->getSourceModel()->labelCount(label);
     if (!label.isEmpty()) {
       if (!customLabels.contains(label)) {
         addLabel(label);
+      } else {
+        const int row = labelFilters->rowFromLabel(label);
+        Q_ASSERT(row >= 2);
+        labelFilters->item(row)->setText(label + " ("+ QString::number(count) +")");
       }
-      // Update label counter
-      Q_ASSERT(customLabels.contains(label));
-      const int new_count = customLabels.value(label, 0) + 1;
-      customLabels.insert(label, new_count);
-      const int row = labelFilters->rowFromLabel(label);
-      qDebug("torrentAdded, Row: %d", row);
-      Q_ASSERT(row >= 2);
-      Q_ASSERT(labelFilters->item(row));
-      labelFilters->item(row)->setText(label + " ("+ QString::number(new_count) +")");
-      ++nb_labeled;
-    }
-    ++nb_torrents;
-    Q_ASSERT(nb_torrents >= 0);
-    Q_ASSERT(nb_labeled >= 0);
-    Q_ASSERT(nb_labeled <= nb_torrents);
-    updateStickyLabelCounters();
-  }
-
-  void torrentAboutToBeDeleted(TorrentModelItem* torrentItem) {
-    Q_ASSERT(torrentItem);
-    QString label = torrentItem->data(TorrentModelItem::TR_LABEL).toString();
-    if (!label.isEmpty()) {
-      // Update label counter
-      const int new_count = customLabels.value(label, 0) - 1;
-      customLabels.insert(label, new_count);
-      const int row = labelFilters->rowFromLabel(label);
-      Q_ASSERT(row >= 2);
-      labelFilters->item(row)->setText(label + " ("+ QString::number(new_count) +")");
-      --nb_labeled;
     }
-    --nb_torrents;
-    qDebug("nb_torrents: %d, nb_labeled: %d", nb_torrents, nb_labeled);
-    Q_ASSERT(nb_torrents >= 0);
-    Q_ASSERT(nb_labeled >= 0);
-    Q_ASSERT(nb_labeled <= nb_torrents);
     updateStickyLabelCounters();
   }
 
   void updateStickyLabelCounters() {
-    labelFilters->item(0)->setText(tr("All labels") + " ("+QString::number(nb_torrents)+")");
-    labelFilters->item(1)->setText(tr("Unlabeled") + " ("+QString::number(nb_torrents-nb_labeled)+")");
+    const TorrentModel *model = transferList->getSourceModel();
+    labelFilters->item(0)->setText(tr("All labels") + " ("+QString::number(model->rowCount())+")");
+    labelFilters->item(1)->setText(tr("Unlabeled") + " ("+QString::number(model->labelCount(QString()))+")");
   }
 
 };
@@ -0,0 +1,79 @@
+#include "transferlistsortmodel.h"
+#include "transferlistwidget.h"
+#include "qtlibtorrent/torrentmodel.h"
+
+TransferListSortModel::TransferListSortModel(QObject *parent) :
+  QSortFilterProxyModel(parent), m_labelFilterEnabled(false), m_statusMask(~0u)
+{
+  setDynamicSortFilter(true);
+  setSortCaseSensitivity(Qt::CaseInsensitive);
+}
+
+void TransferListSortModel::setLabelFilter(const QString &label)
+{
+  m_labelFilterEnabled = (label != "all");
+  m_label = (label == "none") ? QString() : label;
+  invalidateFilter();
+}
+
+void TransferListSortModel::setStatusFilter(int filter)
+{
+  switch(filter) {
+  case FILTER_DOWNLOADING:
+    m_statusMask = (1u << TorrentModelItem::STATE_DOWNLOADING) | (1u << TorrentModelItem::STATE_STALLED_DL) |
+                   (1u << TorrentModelItem::STATE_PAUSED_DL) | (1u << TorrentModelItem::STATE_CHECKING_DL) |
+                   (1u << TorrentModelItem::STATE_QUEUED_DL);
+    break;
+  case FILTER_COMPLETED:
+    m_statusMask = (1u << TorrentModelItem::STATE_SEEDING) | (1u << TorrentModelItem::STATE_STALLED_UP) |
+                   (1u << TorrentModelItem::STATE_PAUSED_UP) | (1u << TorrentModelItem::STATE_CHECKING_UP) |
+                   (1u << TorrentModelItem::STATE_QUEUED_UP);
+    break;
+  case FILTER_ACTIVE:
+    m_statusMask = (1u << TorrentModelItem::STATE_DOWNLOADING) | (1u << TorrentModelItem::STATE_SEEDING);
+    break;
+  case FILTER_INACTIVE:
+    m_statusMask = ~((1u << TorrentModelItem::STATE_DOWNLOADING) | (1u << TorrentModelItem::STATE_SEEDING));
+    break;
+  case FILTER_PAUSED:
+    m_statusMask = (1u << TorrentModelItem::STATE_PAUSED_UP) | (1u << TorrentModelItem::STATE_PAUSED_DL);
+    break;
+  default:
+    m_statusMask = ~0u;
+  }
+  invalidateFilter();
+}
+
+void TransferListSortModel::setNameFilter(const QString &name)
+{
+  m_nameFilter = QRegExp(name, Qt::CaseInsensitive);
+  invalidateFilter();
+}
+
+bool TransferListSortModel::filterAcceptsRow(int source_row, const QModelIndex &source_parent) const
+{
+  const QAbstractItemModel *model = sourceModel();
+  // Cheapest checks first, values are plain reads of the last refresh
+  if (m_statusMask != ~0u) {
+    const QVariant status = model->index(source_row, TorrentModelItem::TR_STATUS, source_parent).data();
+    if (!status.isValid() || !(m_statusMask & (1u << status.toInt())))
+      return false;
+  }
+  if (m_labelFilterEnabled &&
+      model->index(source_row, TorrentModelItem::TR_LABEL, source_parent).data().toString() != m_label)
+    return false;
+  if (!m_nameFilter.isEmpty() &&
+      !model->index(source_row, TorrentModelItem::TR_NAME, source_parent).data().toString().contains(m_nameFilter))
+    return false;
+  return true;
+}
+
+bool TransferListSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
+{
+  if (QSortFilterProxyModel::lessThan(left, right))
+    return true;
+  if (QSortFilterProxyModel::lessThan(right, left))
+    return false;
+  // Equal values keep source order
+  return left.row() < right.row();
+}
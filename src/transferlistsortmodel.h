@@ -0,0 +1,33 @@
+#ifndef TRANSFERLISTSORTMODEL_H
+#define TRANSFERLISTSORTMODEL_H
+
+#include <QSortFilterProxyModel>
+#include <QRegExp>
+#include <QString>
+
+// Applies label, status and name filters of transfer list in one pass
+// Changed source rows are filtered again by QSortFilterProxyModel itself,
+// equal values keep order of source rows so refresh doesn't shuffle rows
+class TransferListSortModel : public QSortFilterProxyModel {
+  Q_OBJECT
+
+public:
+  explicit TransferListSortModel(QObject *parent = 0);
+
+  // "all" accepts any label, "none" accepts transfers without label
+  void setLabelFilter(const QString &label);
+  void setStatusFilter(int filter);
+  void setNameFilter(const QString &name);
+
+protected:
+  bool filterAcceptsRow(int source_row, const QModelIndex &source_parent) const;
+  bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
+
+private:
+  bool m_labelFilterEnabled;
+  QString m_label;
+  uint m_statusMask; // Accepted states bits
+  QRegExp m_nameFilter;
+};
+
+#endif // TRANSFERLISTSORTMODEL_H
@@ -29,7 +29,6 @@
  */
 
 #include <QStandardItemModel>
-#include <QSortFilterProxyModel>
 #include <QDesktopServices>
 #include <QTimer>
 #include <QClipboard>
@@ -60,6 +59,7 @@
 #include "iconprovider.h"
 #include "torrent_properties.h"
 #include "ed2k_link_maker.h"
+#include "transferlistsortmodel.h"
 
 using namespace libtorrent;
 
@@ -77,26 +77,9 @@ TransferListWidget::TransferListWidget(QWidget *parent, MainWindow *main_window,
   listModel = new TorrentModel(this);
 
   // Set Sort/Filter proxy
-  labelFilterModel = new QSortFilterProxyModel();
-  labelFilterModel->setDynamicSortFilter(true);
-  labelFilterModel->setSourceModel(listModel);
-  labelFilterModel->setFilterKeyColumn(TorrentModelItem::TR_LABEL);
-  labelFilterModel->setFilterRole(Qt::DisplayRole);
-
-  statusFilterModel = new QSortFilterProxyModel();
-  statusFilterModel->setDynamicSortFilter(true);
-  statusFilterModel->setSourceModel(labelFilterModel);
-  statusFilterModel->setFilterKeyColumn(TorrentModelItem::TR_STATUS);
-  statusFilterModel->setFilterRole(Qt::DisplayRole);
-
-  nameFilterModel = new QSortFilterProxyModel();
-  nameFilterModel->setDynamicSortFilter(true);
-  nameFilterModel->setSourceModel(statusFilterModel);
-  nameFilterModel->setFilterKeyColumn(TorrentModelItem::TR_NAME);
-  nameFilterModel->setFilterRole(Qt::DisplayRole);
-  nameFilterModel->setSortCaseSensitivity(Qt::CaseInsensitive);
-
-  setModel(nameFilterModel);
+  proxyModel = new TransferListSortModel();
+  proxyModel->setSourceModel(listModel);
+  setModel(proxyModel);
 
   // Visual settings
   setRootIsDecorated(false);
@@ -150,9 +133,7 @@ TransferListWidget::~TransferListWidget() {
   // Save settings
   saveSettings();
   // Clean up
-  delete labelFilterModel;
-  delete statusFilterModel;
-  delete nameFilterModel;
+  delete proxyModel;
   delete listModel;
   delete listDelegate;
   qDebug() << Q_FUNC_INFO << "EXIT";
@@ -181,17 +162,14 @@ inline QString TransferListWidget::getHashFromRow(int row) const {
 
 inline QModelIndex TransferListWidget::mapToSource(const QModelIndex &index) const {
   Q_ASSERT(index.isValid());
-  if (index.model() == nameFilterModel)
-    return labelFilterModel->mapToSource(statusFilterModel->mapToSource(nameFilterModel->mapToSource(index)));
-  if (index.model() == statusFilterModel)
-    return labelFilterModel->mapToSource(statusFilterModel->mapToSource(index));
-  return labelFilterModel->mapToSource(index);
+  Q_ASSERT(index.model() == proxyModel);
+  return proxyModel->mapToSource(index);
 }
 
 inline QModelIndex TransferListWidget::mapFromSource(const QModelIndex &index) const {
   Q_ASSERT(index.isValid());
-  Q_ASSERT(index.model() == labelFilterModel);
-  return nameFilterModel->mapFromSource(statusFilterModel->mapFromSource(labelFilterModel->mapFromSource(index)));
+  Q_ASSERT(index.model() == listModel);
+  return proxyModel->mapFromSource(index);
 }
 
 
@@ -272,8 +250,8 @@ void TransferListWidget::startSelectedTorrents() {
 
 void TransferListWidget::startVisibleTorrents() {
   QStringList hashes;
-  for (int i=0; i<nameFilterModel->rowCount(); ++i) {
-    const int row = mapToSource(nameFilterModel->index(i, 0)).row();
+  for (int i=0; i<proxyModel->rowCount(); ++i) {
+    const int row = mapToSource(proxyModel->index(i, 0)).row();
     hashes << getHashFromRow(row);
   }
   foreach (const QString &hash, hashes) {
@@ -290,8 +268,8 @@ void TransferListWidget::pauseSelectedTorrents() {
 
 void TransferListWidget::pauseVisibleTorrents() {
   QStringList hashes;
-  for (int i=0; i<nameFilterModel->rowCount(); ++i) {
-    const int row = mapToSource(nameFilterModel->index(i, 0)).row();
+  for (int i=0; i<proxyModel->rowCount(); ++i) {
+    const int row = mapToSource(proxyModel->index(i, 0)).row();
     hashes << getHashFromRow(row);
   }
   foreach (const QString &hash, hashes) {
@@ -345,14 +323,14 @@ void TransferListWidget::deleteSelectedTorrents()
 
 void TransferListWidget::deleteVisibleTorrents()
 {
-  if (nameFilterModel->rowCount() <= 0) return;
+  if (proxyModel->rowCount() <= 0) return;
   bool delete_local_files = false;
   if (Preferences().confirmTorrentDeletion() &&
       !DeletionConfirmationDlg::askForDeletionConfirmation(true, &delete_local_files)) // TODO - delete it?
     return;
   QStringList hashes;
-  for (int i=0; i<nameFilterModel->rowCount(); ++i) {
-    const int row = mapToSource(nameFilterModel->index(i, 0)).row();
+  for (int i=0; i<proxyModel->rowCount(); ++i) {
+    const int row = mapToSource(proxyModel->index(i, 0)).row();
     hashes << getHashFromRow(row);
   }
   foreach (const QString &hash, hashes) {
@@ -703,7 +681,7 @@ void TransferListWidget::renameSelectedTorrent() {
   if (ok && !name.isEmpty()) {
     if (h.type() == Transfer::ED2K) h.rename_file(0, name);
     // Rename the transfer
-    nameFilterModel->setData(selectedIndexes.first(), name, Qt::DisplayRole);
+    proxyModel->setData(selectedIndexes.first(), name, Qt::DisplayRole);
   }
 }
 
@@ -986,50 +964,20 @@ void TransferListWidget::currentChanged(const QModelIndex& current, const QModel
 }
 
 void TransferListWidget::applyLabelFilter(QString label) {
-  if (label == "all") {
-    labelFilterModel->setFilterRegExp(QRegExp());
-    return;
-  }
-  if (label == "none") {
-    labelFilterModel->setFilterRegExp(QRegExp("^$"));
-    return;
-  }
   qDebug("Applying Label filter: %s", qPrintable(label));
-  labelFilterModel->setFilterRegExp(QRegExp("^"+label+"$", Qt::CaseSensitive));
+  proxyModel->setLabelFilter(label);
 }
 
 void TransferListWidget::applyNameFilter(QString name) {
-  nameFilterModel->setFilterRegExp(QRegExp(name, Qt::CaseInsensitive));
+  proxyModel->setNameFilter(name);
 }
 
 void TransferListWidget::applyStatusFilter(int f) {
-  switch(f) {
-  case FILTER_DOWNLOADING:
-    statusFilterModel->setFilterRegExp(QRegExp(QString::number(TorrentModelItem::STATE_DOWNLOADING)+"|"+QString::number(TorrentModelItem::STATE_STALLED_DL)+"|"+
-                                               QString::number(TorrentModelItem::STATE_PAUSED_DL)+"|"+QString::number(TorrentModelItem::STATE_CHECKING_DL)+"|"+
-                                               QString::number(TorrentModelItem::STATE_QUEUED_DL), Qt::CaseSensitive));
-    break;
-  case FILTER_COMPLETED:
-    statusFilterModel->setFilterRegExp(QRegExp(QString::number(TorrentModelItem::STATE_SEEDING)+"|"+QString::number(TorrentModelItem::STATE_STALLED_UP)+"|"+
-                                               QString::number(TorrentModelItem::STATE_PAUSED_UP)+"|"+QString::number(TorrentModelItem::STATE_CHECKING_UP)+"|"+
-                                               QString::number(TorrentModelItem::STATE_QUEUED_UP), Qt::CaseSensitive));
-    break;
-  case FILTER_ACTIVE:
-    statusFilterModel->setFilterRegExp(QRegExp(QString::number(TorrentModelItem::STATE_DOWNLOADING)+"|"+QString::number(TorrentModelItem::STATE_SEEDING), Qt::CaseSensitive));
-    break;
-  case FILTER_INACTIVE:
-    statusFilterModel->setFilterRegExp(QRegExp("[^"+QString::number(TorrentModelItem::STATE_DOWNLOADING)+QString::number(TorrentModelItem::STATE_SEEDING)+"]", Qt::CaseSensitive));
-    break;
-  case FILTER_PAUSED:
-    statusFilterModel->setFilterRegExp(QRegExp(QString::number(TorrentModelItem::STATE_PAUSED_UP)+"|"+QString::number(TorrentModelItem::STATE_PAUSED_DL)));
-    break;
-  default:
-    statusFilterModel->setFilterRegExp(QRegExp());
-  }
+  proxyModel->setStatusFilter(f);
   // Select first item if nothing is selected
-  if (selectionModel()->selectedRows(0).empty() && nameFilterModel->rowCount() > 0) {
-    qDebug("Nothing is selected, selecting first row: %s", qPrintable(nameFilterModel->index(0, TorrentModelItem::TR_NAME).data().toString()));
-    selectionModel()->setCurrentIndex(nameFilterModel->index(0, TorrentModelItem::TR_NAME), QItemSelectionModel::SelectCurrent|QItemSelectionModel::Rows);
+  if (selectionModel()->selectedRows(0).empty() && proxyModel->rowCount() > 0) {
+    qDebug("Nothing is selected, selecting first row: %s", qPrintable(proxyModel->index(0, TorrentModelItem::TR_NAME).data().toString()));
+    selectionModel()->setCurrentIndex(proxyModel->index(0, TorrentModelItem::TR_NAME), QItemSelectionModel::SelectCurrent|QItemSelectionModel::Rows);
   }
 }
 
@@ -39,9 +39,9 @@ class Session;
 class TransferListDelegate;
 class MainWindow;
 class TorrentModel;
+class TransferListSortModel;
 
 QT_BEGIN_NAMESPACE
-class QSortFilterProxyModel;
 class QStandardItemModel;
 QT_END_NAMESPACE
 
@@ -54,6 +54,7 @@ public:
   TransferListWidget(QWidget *parent, MainWindow *main_window, Session* BTSession);
   ~TransferListWidget();
   TorrentModel* getSourceModel() const;
+  QStringList getSelectedTorrentsHashes() const;
 
 public slots:
   void setSelectionLabel(QString label);
@@ -95,7 +96,6 @@ protected:
   QStringList getCustomLabels() const;
   void saveSettings();
   bool loadSettings();
-  QStringList getSelectedTorrentsHashes() const;
 
 protected slots:
   void torrentDoubleClicked(const QModelIndex& index);
@@ -114,9 +114,7 @@ signals:
 private:
   TransferListDelegate *listDelegate;
   TorrentModel *listModel;
-  QSortFilterProxyModel *nameFilterModel;
-  QSortFilterProxyModel *statusFilterModel;
-  QSortFilterProxyModel *labelFilterModel;
+  TransferListSortModel *proxyModel;
   Session* BTSession;
   MainWindow *main_window;
   QAction* actionAddLink;
@@ -0,0 +1,150 @@
+#include <QMutexLocker>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+
+#include <boost/system/error_code.hpp>
+
+#include "collection_builder.h"
+
+#include <libed2k/file.hpp>
+#include <libed2k/filesystem.hpp>
+
+CollectionBuilder::CollectionBuilder(QObject* parent /*= 0*/) : QThread(parent), m_abort(0), m_hashing(NULL)
+{
+}
+
+CollectionBuilder::~CollectionBuilder()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_abort.fetchAndStoreOrdered(1);
+        if (m_hashing) *m_hashing = true;
+        m_cond.wakeOne();
+    }
+
+    wait();
+}
+
+void CollectionBuilder::enqueue(const QList<CollectionTask>& tasks)
+{
+    if (tasks.isEmpty()) return;
+    QMutexLocker locker(&m_mutex);
+    m_queue << tasks;
+    m_cond.wakeOne();
+}
+
+QList<CollectionTask> CollectionBuilder::takeResults()
+{
+    QMutexLocker locker(&m_mutex);
+    QList<CollectionTask> res;
+    res.swap(m_results);
+    return res;
+}
+
+void CollectionBuilder::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.clear();
+}
+
+void CollectionBuilder::run()
+{
+    forever
+    {
+        QList<CollectionTask> batch;
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while (m_queue.isEmpty() && !m_abort)
+                m_cond.wait(&m_mutex);
+
+            if (m_abort) break;
+            batch.swap(m_queue);
+        }
+
+        for (QList<CollectionTask>::iterator itr = batch.begin(); itr != batch.end() && !m_abort; ++itr)
+        {
+            build(*itr);
+        }
+
+        if (m_abort) break;
+
+        {
+            QMutexLocker locker(&m_mutex);
+            m_results << batch;
+        }
+
+        emit collectionsReady();
+    }
+}
+
+void CollectionBuilder::build(CollectionTask& task)
+{
+    int iteration = 0;
+    // generate unique filename
+    QDir cd(task.m_location);
+
+    while(task.m_filepath.isEmpty())
+    {
+        QString filename = task.m_name + (iteration?(QString("_") + QString::number(iteration)):QString()) +
+                QString("-") + QString::number(task.m_entries.size()) + QString(".emulecollection");
+        QFileInfo fi(cd.filePath(filename));
+
+        if (fi.exists())
+        {
+            ++iteration;
+        }
+        else
+        {
+            task.m_filepath = fi.absoluteFilePath();
+        }
+    }
+
+    qDebug() << "collection filepath " << task.m_filepath;
+
+    QFile data(task.m_filepath);
+
+    if (!data.open(QFile::WriteOnly | QFile::Truncate))
+    {
+        task.m_ec = boost::system::errc::make_error_code(boost::system::errc::io_error);
+        return;
+    }
+
+    // write links line by line, entries are utf-8 already
+    for (std::vector<CollectionEntry>::const_iterator itr = task.m_entries.begin(); itr != task.m_entries.end(); ++itr)
+    {
+        std::string line = itr->m_pending.isEmpty()?
+            libed2k::emule_collection::toLink(itr->m_filename, itr->m_filesize, itr->m_hash):
+            std::string("# empty line ") + itr->m_pending.toAscii().constData();
+        line += '\n';
+        data.write(line.c_str(), line.size());
+    }
+
+    data.close();
+
+    // entries are not needed anymore, free memory before hashing
+    std::vector<CollectionEntry>().swap(task.m_entries);
+
+    // file2atp polls plain flag, destructor raises it for collection in progress
+    bool cancel = false;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_abort) return;
+        m_hashing = &cancel;
+    }
+
+    std::pair<libed2k::add_transfer_params, libed2k::error_code> res_pair =
+        libed2k::file2atp()(task.m_filepath.toUtf8().constData(), cancel);
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_hashing = NULL;
+    }
+
+    task.m_atp = res_pair.first;
+    task.m_ec = res_pair.second;
+}
@@ -0,0 +1,79 @@
+#ifndef __COLLECTION_BUILDER__
+#define __COLLECTION_BUILDER__
+
+#include <vector>
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QAtomicInt>
+#include <QString>
+#include <QList>
+
+#include <libed2k/add_transfer_params.hpp>
+#include <libed2k/error_code.hpp>
+#include <libed2k/md4_hash.hpp>
+
+class DirNode;
+
+/**
+  * single file line of emulecollection
+ */
+struct CollectionEntry
+{
+    std::string         m_filename;
+    quint64             m_filesize;
+    libed2k::md4_hash   m_hash;
+    QString             m_pending;  // transfer hash of file which isn't hashed yet, written as comment line
+};
+
+/**
+  * snapshot of shared directory prepared on session thread
+  * worker fills result fields
+ */
+struct CollectionTask
+{
+    const DirNode*  m_node;     // identity only, never dereferenced by worker
+    int             m_ticket;   // task is actual while session has same ticket for node
+    QString         m_location; // collections directory
+    QString         m_name;     // collection name without counters and extension
+    std::vector<CollectionEntry> m_entries;
+
+    QString                         m_filepath;
+    libed2k::add_transfer_params    m_atp;
+    libed2k::error_code             m_ec;
+};
+
+/**
+  * writes and hashes emulecollection files in background
+  * session receives collectionsReady and takes all finished tasks at once
+ */
+class CollectionBuilder : public QThread
+{
+    Q_OBJECT
+public:
+    CollectionBuilder(QObject* parent = 0);
+    ~CollectionBuilder();
+
+    void enqueue(const QList<CollectionTask>& tasks);
+    QList<CollectionTask> takeResults();
+
+    /**
+      * drop queued tasks, task in progress will finish
+     */
+    void clear();
+protected:
+    void run();
+private:
+    void build(CollectionTask& task);
+
+    QAtomicInt              m_abort;    // set on destruction, polled by worker between tasks
+    bool*                   m_hashing;  // cancel flag of collection being hashed, guarded by mutex
+    QWaitCondition          m_cond;
+    mutable QMutex          m_mutex;
+    QList<CollectionTask>   m_queue;
+    QList<CollectionTask>   m_results;
+signals:
+    void collectionsReady();
+};
+
+#endif //__COLLECTION_BUILDER__
@@ -0,0 +1,96 @@
+#include "file_name_index.h"
+
+void FileNameIndex::add(const QString& hash, const QString& name)
+{
+    QHash<QString, Entry>::iterator itr = m_entries.find(hash);
+
+    if (itr != m_entries.end())
+    {
+        ++itr->refs;
+        return;
+    }
+
+    Entry entry;
+    entry.words = words(name);
+    entry.refs = 1;
+
+    foreach(const QString& word, entry.words)
+        m_words[word].insert(hash);
+
+    m_entries.insert(hash, entry);
+}
+
+void FileNameIndex::remove(const QString& hash)
+{
+    QHash<QString, Entry>::iterator itr = m_entries.find(hash);
+    if (itr == m_entries.end()) return;
+    if (--itr->refs > 0) return;
+
+    foreach(const QString& word, itr->words)
+    {
+        QMap<QString, QSet<QString> >::iterator witr = m_words.find(word);
+        Q_ASSERT(witr != m_words.end());
+        witr->remove(hash);
+        if (witr->isEmpty()) m_words.erase(witr);
+    }
+
+    m_entries.erase(itr);
+}
+
+void FileNameIndex::clear()
+{
+    m_entries.clear();
+    m_words.clear();
+}
+
+QSet<QString> FileNameIndex::match(const QString& query) const
+{
+    QStringList query_words = words(query);
+    QSet<QString> res;
+    if (query_words.isEmpty()) return res;
+
+    res = prefixed(query_words.first());
+
+    for (int i = 1; i < query_words.size() && !res.isEmpty(); ++i)
+        res.intersect(prefixed(query_words.at(i)));
+
+    return res;
+}
+
+QStringList FileNameIndex::words(const QString& str)
+{
+    QStringList res;
+    const QString lower = str.toLower();
+    int start = -1;
+
+    for (int i = 0; i <= lower.size(); ++i)
+    {
+        bool letter = i < lower.size() && lower.at(i).isLetterOrNumber();
+
+        if (letter && start < 0)
+        {
+            start = i;
+        }
+        else if (!letter && start >= 0)
+        {
+            QString word = lower.mid(start, i - start);
+            if (!res.contains(word)) res << word;
+            start = -1;
+        }
+    }
+
+    return res;
+}
+
+QSet<QString> FileNameIndex::prefixed(const QString& word) const
+{
+    QSet<QString> res;
+
+    for (QMap<QString, QSet<QString> >::const_iterator itr = m_words.lowerBound(word);
+         itr != m_words.constEnd() && itr.key().startsWith(word); ++itr)
+    {
+        res.unite(itr.value());
+    }
+
+    return res;
+}
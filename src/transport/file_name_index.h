@@ -0,0 +1,47 @@
+#ifndef __FILE_NAME_INDEX__
+#define __FILE_NAME_INDEX__
+
+#include <QHash>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+/**
+  * inverted index of file names: lowercase words of name to file hashes
+  * hash added several times stays in index until it is removed same times
+ */
+class FileNameIndex
+{
+public:
+    void add(const QString& hash, const QString& name);
+    void remove(const QString& hash);
+    void clear();
+
+    bool contains(const QString& hash) const { return m_entries.contains(hash); }
+    int size() const { return m_entries.size(); }
+
+    /**
+      * hashes of files which have word starting with every word of query
+      * empty query matches nothing
+     */
+    QSet<QString> match(const QString& query) const;
+
+    /**
+      * lowercase words of letters and digits
+     */
+    static QStringList words(const QString& str);
+private:
+    QSet<QString> prefixed(const QString& word) const;
+
+    struct Entry
+    {
+        QStringList words;
+        int         refs;
+    };
+
+    QHash<QString, Entry>           m_entries;
+    QMap<QString, QSet<QString> >   m_words;    // sorted for prefix ranges
+};
+
+#endif //__FILE_NAME_INDEX__
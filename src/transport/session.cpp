@@ -9,6 +9,8 @@
 #endif
 
 #include "transport/session.h"
+#include "transport/collection_builder.h"
+#include "transport/share_transaction.h"
 #include "torrentpersistentdata.h"
 
 using namespace libtorrent;
@@ -86,12 +88,16 @@ Session::~Session()
 { 
 }
 
-Session::Session() : m_root(NULL, QFileInfo(), true), m_delay(10000)
+Session::Session() : m_root(NULL, QFileInfo(), true), m_delay(10000), m_collection_ticket(0)
 {
     // prepare sessions container
     m_sessions.push_back(&m_btSession);
     m_sessions.push_back(&m_edSession);
 
+    // connected first, so hashes set is actual for all other receivers
+    connect(this, SIGNAL(addedTransfer(Transfer)), this, SLOT(on_addedTransfer(Transfer)));
+    connect(this, SIGNAL(deletedTransfer(QString)), this, SLOT(on_deletedTransfer(QString)));
+
     // libtorrent signals
     connect(&m_btSession, SIGNAL(addedTorrent(QTorrentHandle)),
             this, SLOT(on_addedTorrent(QTorrentHandle)));
@@ -119,10 +125,6 @@ Session::Session() : m_root(NULL, QFileInfo(), true), m_delay(10000)
             this, SIGNAL(recursiveDownloadPossible(QTorrentHandle)));
     connect(&m_btSession, SIGNAL(savePathChanged(QTorrentHandle)),
             this, SLOT(on_savePathChanged(QTorrentHandle)));
-    connect(&m_btSession, SIGNAL(newConsoleMessage(QString)),
-            this, SIGNAL(newConsoleMessage(QString)));
-    connect(&m_btSession, SIGNAL(newBanMessage(QString)),
-            this, SIGNAL(newBanMessage(QString)));
     connect(&m_btSession, SIGNAL(fileError(Transfer, QString)),
             this, SIGNAL(fileError(Transfer, QString)));
 
@@ -132,6 +134,12 @@ Session::Session() : m_root(NULL, QFileInfo(), true), m_delay(10000)
     connect(m_alerts_reading.data(), SIGNAL(timeout()), SLOT(readAlerts()));
     connect(m_periodic_resume.data(), SIGNAL(timeout()), SLOT(saveTempFastResumeData()));
 
+    // node changes are collected and delivered to models once per event loop iteration
+    m_changes_flush.reset(new QTimer(this));
+    m_changes_flush->setSingleShot(true);
+    m_changes_flush->setInterval(0);
+    connect(m_changes_flush.data(), SIGNAL(timeout()), SLOT(flush_changes()));
+
     m_alerts_reading->start(1000);
     m_periodic_resume->start(270000);   // 3 min
 
@@ -156,6 +164,10 @@ Session::Session() : m_root(NULL, QFileInfo(), true), m_delay(10000)
 
     m_speedMonitor.reset(new TorrentSpeedMonitor(this));
     m_speedMonitor->start();
+
+    m_collectionBuilder.reset(new CollectionBuilder(this));
+    connect(m_collectionBuilder.data(), SIGNAL(collectionsReady()), this, SLOT(on_collectionsReady()), Qt::QueuedConnection);
+    m_collectionBuilder->start();
 }
 
 QBtSession* Session::get_torrent_session() { return &m_btSession; }
@@ -242,8 +254,6 @@ void Session::changeLabelInSavePath(
     const Transfer& t, const QString& old_label, const QString& new_label) {
     return delegate(t)->changeLabelInSavePath(t, old_label, new_label);
 }
-QStringList Session::getConsoleMessages() const { return m_btSession.getConsoleMessages(); }
-QStringList Session::getPeerBanMessages() const { return m_btSession.getPeerBanMessages(); }
 SessionStatus Session::getSessionStatus() const {
     return m_edSession.getSessionStatus() + m_btSession.getSessionStatus();
 }
@@ -405,6 +415,8 @@ void Session::addTransferFromFile(const QString& filename)
     }
 }
 
+void Session::on_addedTransfer(Transfer t) { m_transfer_hashes.insert(t.hash()); }
+void Session::on_deletedTransfer(const QString& hash) { m_transfer_hashes.remove(hash); }
 void Session::on_addedTorrent(const QTorrentHandle& h) { emit addedTransfer(Transfer(h)); }
 void Session::on_pausedTorrent(const QTorrentHandle& h) { emit pausedTransfer(Transfer(h)); }
 
@@ -463,6 +475,8 @@ void Session::on_transferAboutToBeRemoved(const Transfer& t, bool del_files)
     {
         FileNode* node = itr.value();
         Q_ASSERT(node);
+        // receivers see file isn't shared anymore
+        m_shared_names.remove(itr.key());
         emit removeSharedFile(node);
         m_files.erase(itr);
 
@@ -505,6 +519,8 @@ void Session::saveFastResumeData()
     m_periodic_resume->stop();
     m_alerts_reading->stop();
     m_delay.cancel();
+    m_collectionBuilder->clear();
+    m_pending_collections.clear();
     for (std::set<DirNode*>::const_iterator itr = m_dirs.begin(); itr != m_dirs.end(); ++itr)
     {
         const DirNode* p = *itr;
@@ -547,10 +563,17 @@ void Session::on_transferParametersReady(const libed2k::add_transfer_params& atp
 void Session::removeDirectory(DirNode* dir)
 {
     emit removeSharedDirectory(dir);
-    m_dirs.erase(dir);    
+    m_dirs.erase(dir);
+    cancel_collection(dir);
     m_delay.execute(boost::bind(&Session::prepare_collections, Session::instance()));
 }
 
+void Session::deleteDirectory(const DirNode* dir)
+{
+    foreach(ShareTransaction* transaction, m_transactions)
+        transaction->removeDirectory(dir);
+}
+
 void Session::addDirectory(DirNode* dir)
 {
     m_dirs.insert(dir);    
@@ -558,8 +581,39 @@ void Session::addDirectory(DirNode* dir)
     m_delay.execute(boost::bind(&Session::prepare_collections, Session::instance()));
 }
 
+void Session::signal_changeNode(const FileNode* node)
+{
+    m_changed_nodes.insert(node);
+    if (m_transactions.isEmpty() && !m_changes_flush->isActive()) m_changes_flush->start();
+}
+
+void Session::flush_changes()
+{
+    m_changes_flush->stop();
+    if (m_changed_nodes.isEmpty()) return;
+
+    QList<const FileNode*> nodes = m_changed_nodes.toList();
+    m_changed_nodes.clear();
+    emit changeNodes(nodes);
+}
+
+QList<FileNode*> Session::findSharedFiles(const QString& query) const
+{
+    QList<FileNode*> res;
+
+    foreach(const QString& hash, m_shared_names.match(query))
+    {
+        FileNode* node = m_files.value(hash);
+        if (node) res << node;
+    }
+
+    return res;
+}
+
 void Session::registerNode(FileNode* node)
 {
+    if (!m_files.contains(node->hash()))
+        m_shared_names.add(node->hash(), node->filename());
     m_files.insert(node->hash(), node);
     emit insertSharedFile(node);
 }
@@ -680,7 +734,7 @@ FileNode* Session::node(const QString& filepath)
 
             // generate node with fake info and next request real info
             node = new DirNode(parent, info);
-            node->m_filename = element;            
+            node->set_filename(element);
             QFileInfo node_info(node->filepath());
             node->m_info = node_info;
             parent->add_node(node);
@@ -724,19 +778,55 @@ FileNode* Session::node(const QString& filepath)
 
 void Session::prepare_collections()
 {
-    int i = 10; // limit collections sharing at moment to avoid gui hang up
+    QList<CollectionTask> tasks;
+
     for (std::set<DirNode*>::iterator itr = m_dirs.begin(); itr != m_dirs.end(); ++itr)
     {
         DirNode* p = *itr;
 
-        if (p->is_active() && !p->has_transfer())
+        if (p->is_active() && !p->has_transfer() && !m_pending_collections.contains(p))
         {
-            p->build_collection();
-            --i;
+            CollectionTask task;
+
+            if (p->prepare_collection(task))
+            {
+                task.m_ticket = ++m_collection_ticket;
+                m_pending_collections.insert(p, task.m_ticket);
+                tasks << task;
+            }
         }
+    }
+
+    qDebug() << "prepare collections " << tasks.size();
+    m_collectionBuilder->enqueue(tasks);
+}
 
-        if (i == 0)
-            break;
+void Session::cancel_collection(const DirNode* dir)
+{
+    // result of cancelled task will be dropped on arrival
+    m_pending_collections.remove(dir);
+}
+
+void Session::on_collectionsReady()
+{
+    foreach(const CollectionTask& task, m_collectionBuilder->takeResults())
+    {
+        QHash<const DirNode*, int>::iterator itr = m_pending_collections.find(task.m_node);
+
+        if (itr == m_pending_collections.end() || itr.value() != task.m_ticket)
+        {
+            // directory was changed or unshared while collection was building
+            qDebug() << "drop outdated collection " << task.m_filepath;
+            if (!task.m_filepath.isEmpty()) QFile::remove(task.m_filepath);
+            continue;
+        }
+
+        m_pending_collections.erase(itr);
+        // node is alive while it is in shared directories
+        DirNode* p = const_cast<DirNode*>(task.m_node);
+        if (m_dirs.find(p) == m_dirs.end()) continue;
+        p->on_collection_ready(task.m_atp, task.m_ec);
+        signal_changeNode(p);
     }
 }
 
@@ -863,6 +953,8 @@ void Session::loadFileSystem()
 void Session::dropDirectoryTransfers()
 {
     m_delay.cancel();
+    m_collectionBuilder->clear();
+    m_pending_collections.clear();
 
     for (std::set<DirNode*>::const_iterator itr = m_dirs.begin(); itr != m_dirs.end(); ++itr)
     {
@@ -876,6 +968,25 @@ void Session::dropDirectoryTransfers()
     }
 }
 
+ShareTransaction* Session::shareTransaction(DirNode* node, bool share)
+{
+    ShareTransaction* transaction = new ShareTransaction(node, share, this);
+    connect(transaction, SIGNAL(finished()), this, SLOT(on_transactionFinished()));
+    m_transactions << transaction;
+    transaction->start();
+    return transaction;
+}
+
+void Session::on_transactionFinished()
+{
+    ShareTransaction* transaction = qobject_cast<ShareTransaction*>(sender());
+    bool removed = m_transactions.removeOne(transaction);
+    Q_ASSERT(removed);
+    Q_UNUSED(removed);
+    transaction->deleteLater();
+    if (m_transactions.isEmpty()) flush_changes();
+}
+
 void Session::share(const QString& filepath, bool recursive)
 {
     FileNode* p = node(filepath);
@@ -3,6 +3,7 @@
 #define __SESSION_H__
 
 #include <QScopedPointer>
+#include <QSet>
 
 #include "delay.h"
 #include "transport/transfer.h"
@@ -10,7 +11,10 @@
 #include "qtlibed2k/qed2ksession.h"
 #include "torrentspeedmonitor.h"
 #include "session_filesystem.h"
+#include "file_name_index.h"
 
+class CollectionBuilder;
+class ShareTransaction;
 
 /**
  * Generic data transfer session
@@ -33,13 +37,15 @@ public:
     bool started() const;
 
     Transfer getTransfer(const QString& hash) const;
+    /**
+      * transfer with hash is in session, no lookup in libraries
+     */
+    bool hasTransfer(const QString& hash) const { return m_transfer_hashes.contains(hash); }
     std::vector<Transfer> getTransfers() const;
     std::vector<Transfer> getActiveTransfers() const;
     qlonglong getETA(const QString& hash) const;
     qreal getGlobalMaxRatio() const;
     qreal getMaxRatioPerTransfer(const QString& hash, bool* use_global) const;
-    QStringList getConsoleMessages() const;
-    QStringList getPeerBanMessages() const;
     SessionStatus getSessionStatus() const;
     void changeLabelInSavePath(const Transfer& t, const QString& old_label, const QString& new_label);
     QTorrentHandle addTorrent(const QString& path, bool fromScanDir = false,
@@ -75,9 +81,23 @@ public:
     void dropDirectoryTransfers();
     void share(const QString& filepath, bool recursive);
     void unshare(const QString& filepath, bool recursive);
+
+    /**
+      * recursive share/unshare of directory in small steps on session thread
+      * node changes are delivered to models once when transaction completes
+     */
+    ShareTransaction* shareTransaction(DirNode* node, bool share);
     DirNode* root() { return &m_root; }
     std::set<DirNode*>& directories() { return m_dirs; }
     QHash<QString, FileNode*>& files() { return m_files; }
+    /**
+      * names of registered files, answers "already sharing" checks without server
+     */
+    const FileNameIndex& sharedNames() const { return m_shared_names; }
+    /**
+      * registered files which have word starting with every word of query
+     */
+    QList<FileNode*> findSharedFiles(const QString& query) const;
 
 public slots:
     void playPendingMedia();
@@ -98,13 +118,12 @@ signals:
     void downloadFromUrlFailure(QString url, QString reason);
     void alternativeSpeedsModeChanged(bool alternative);
     void recursiveDownloadPossible(QTorrentHandle t);    
-    void newBanMessage(QString msg);
     // filesystem signals
-    void changeNode(const FileNode* node);
+    void changeNodes(const QList<const FileNode*>& nodes);
     void beginRemoveNode(const FileNode* node);
     void endRemoveNode();
-    void beginInsertNode(const FileNode* node);
-    void endInsertNode();
+    void beginInsertNodes(const DirNode* parent, bool dirs, int count);
+    void endInsertNodes();
 
     void removeSharedDirectory(const DirNode*);
     void insertSharedDirectory(const DirNode*);
@@ -115,6 +134,8 @@ signals:
     void beginLoadSharedFileSystem();
     void endLoadSharedFileSystem();
 private slots:
+    void on_addedTransfer(Transfer t);
+    void on_deletedTransfer(const QString& hash);
     void on_addedTorrent(const QTorrentHandle& h);
     void on_pausedTorrent(const QTorrentHandle& h);
     void on_finishedTorrent(const QTorrentHandle& h);
@@ -131,6 +152,9 @@ private slots:
     void on_registerNode(Transfer);
     void on_transferParametersReady(const libed2k::add_transfer_params&, const libed2k::error_code&);
     void on_ED2KResumeDataLoaded();
+    void on_collectionsReady();
+    void flush_changes();
+    void on_transactionFinished();
 
 private:
     Session();
@@ -145,6 +169,10 @@ private:
 
     void addDirectory(DirNode* dir);
     void removeDirectory(DirNode* dir);
+    /**
+      * directory and its subtree will be deleted, share transactions must forget them
+     */
+    void deleteDirectory(const DirNode* dir);
     void setDirectLink(const QString& hash, DirNode* node);
     void registerNode(FileNode*);
     FileNode* node(const QString& filepath);
@@ -152,10 +180,11 @@ private:
     // emitters
     void signal_beginRemoveNode(const FileNode* node) { emit beginRemoveNode(node);}
     void signal_endRemoveNode() { emit endRemoveNode();}
-    void signal_beginInsertNode(const FileNode* node) { emit beginInsertNode(node);}
-    void signal_endInsertNode() { emit endInsertNode();}
-    void signal_changeNode(const FileNode* node) { emit changeNode(node);}
+    void signal_beginInsertNodes(const DirNode* parent, bool dirs, int count) { emit beginInsertNodes(parent, dirs, count);}
+    void signal_endInsertNodes() { emit endInsertNodes();}
+    void signal_changeNode(const FileNode* node);
     void prepare_collections();
+    void cancel_collection(const DirNode* dir);
 
     static Session* m_instance;
 
@@ -166,17 +195,26 @@ private:
     QScopedPointer<TorrentSpeedMonitor> m_speedMonitor;
     QScopedPointer<QTimer>  m_periodic_resume;
     QScopedPointer<QTimer>  m_alerts_reading;
+    QScopedPointer<CollectionBuilder> m_collectionBuilder;
+    QScopedPointer<QTimer>  m_changes_flush;
 
     std::set<QPair<QString, int> > m_pending_medias;
 
     DirNode m_root;
     Delay                       m_delay;
     QHash<QString, FileNode*>   m_files;    // all registered files in ed2k filesystem
+    FileNameIndex               m_shared_names; // names of m_files
+    QSet<QString>               m_transfer_hashes;  // hashes of all transfers, follows added/deleted signals
     std::set<DirNode*>          m_dirs;     // shared directories
+    QSet<const FileNode*>       m_changed_nodes;    // nodes changed in current event loop iteration
+    QList<ShareTransaction*>    m_transactions;     // active share transactions hold changes back
     QString                     m_incoming; // incoming filepath
+    QHash<const DirNode*, int>  m_pending_collections;  // directories in collection builder with task ticket
+    int                         m_collection_ticket;
 
     friend class DirNode;
     friend class FileNode;
+    friend class ShareTransaction;
 };
 
 #endif
@@ -88,14 +88,14 @@ bool SessionBase::hasActiveTransfers() const
 
 void SessionBase::addConsoleMessage(QString msg, QColor color/*=QApplication::palette().color(QPalette::WindowText)*/)
 {
-    if (consoleMessages.size() > MAX_LOG_MESSAGES)
-    {
-        consoleMessages.removeFirst();
-    }
+    LogRecord::Level level = LogRecord::L_INFO;
+
+    if (color == Qt::red)
+        level = LogRecord::L_CRITICAL;
+    else if (color == Qt::blue)
+        level = LogRecord::L_NOTICE;
 
-    msg = "<font color='grey'>"+ QDateTime::currentDateTime().toString(QString::fromUtf8("dd/MM/yyyy hh:mm:ss")) + "</font> - <font color='" + color.name() + "'><i>" + msg + "</i></font>";
-    consoleMessages.append(msg);
-    emit newConsoleMessage(msg);
+    SessionLog::instance()->add(SessionLog::J_CONSOLE, LogRecord(logSource(), level, LogRecord::M_TEXT, msg, color.rgb()));
 }
 
 bool SessionBase::isFilePreviewPossible(const QString& hash) const
@@ -16,6 +16,7 @@
 
 #include "transport/transfer.h"
 #include "qtlibtorrent/trackerinfos.h"
+#include "transport/session_log.h"
 
 struct ErrorCode
 {
@@ -54,8 +55,6 @@ struct SessionStatus
         payload_upload_rate(s.payload_upload_rate), payload_download_rate(s.payload_download_rate) {}
 };
 
-const int MAX_LOG_MESSAGES = 100;
-
 class SessionBase : public QObject
 {
     Q_OBJECT
@@ -98,7 +97,9 @@ public:
     // implemented methods
     virtual qreal getRealRatio(const QString& hash) const;
     virtual bool hasActiveTransfers() const;
-    inline virtual QStringList getConsoleMessages() const { return consoleMessages; }
+    /**
+      * add record to console journal of SessionLog, red is critical and blue is notice level
+     */
     virtual void addConsoleMessage(
         QString msg, QColor color=QApplication::palette().color(QPalette::WindowText));
     virtual bool isFilePreviewPossible(const QString& hash) const;
@@ -126,11 +127,10 @@ signals:
     void deletedTransfer(QString hash);
     void transferAboutToBeRemoved(Transfer t, bool del_files);
     void savePathChanged(Transfer t);
-    void newConsoleMessage(const QString &msg);
     void fileError(Transfer t, QString msg);
 
-private:
-    QStringList consoleMessages;
+protected:
+    virtual LogRecord::Source logSource() const { return LogRecord::S_APPLICATION; }
 };
 
 #define DEFER0(call)                                            \
@@ -1,11 +1,11 @@
 #include <QDirIterator>
 #include <QFileSystemModel>
-#include <QTextStream>
-#include <algorithm>
 
 #include "session_filesystem.h"
+#include "collection_builder.h"
 #include "session.h"
 #include "preferences.h"
+#include "natural_sort.h"
 
 #include <libed2k/md4_hash.hpp>
 #include <libed2k/file.hpp>
@@ -29,9 +29,14 @@ FileNode::FileNode(DirNode* parent, const QFileInfo& info) :
     m_parent(parent),
     m_active(false),
     m_info(info),
-    m_atp(NULL)
+    m_atp(NULL),
+    m_reported_active(false),
+    m_reported_complete(false),
+    m_row(-1),
+    m_level((parent && !parent->is_root()) ? (parent->level() + 1) : 0)
 {
     m_filename = m_info.fileName();
+    m_sort_key = naturalKey(m_filename);
 }
 
 FileNode::~FileNode()
@@ -52,15 +57,41 @@ void FileNode::create_transfer()
     catch(const libed2k::libed2k_exception& e)
     {
         m_error = e.error();
-        m_active = false;
+        set_active(false);
     }
 }
 
+void FileNode::set_active(bool active)
+{
+    m_active = active;
+    update_aggregates();
+}
+
+void FileNode::update_aggregates()
+{
+    bool active = contains_active_children();
+    bool complete = is_complete();
+
+    if (active == m_reported_active && complete == m_reported_complete)
+        return;
+
+    if (m_parent)
+    {
+        if (active != m_reported_active) m_parent->m_active_children += (active ? 1 : -1);
+        if (complete != m_reported_complete) m_parent->m_complete_children += (complete ? 1 : -1);
+    }
+
+    m_reported_active = active;
+    m_reported_complete = complete;
+
+    if (m_parent) m_parent->update_aggregates();
+}
+
 void FileNode::share(bool recursive)
 {
     Q_UNUSED(recursive);
     if (m_active) return;
-    m_active = true;
+    set_active(true);
 
     if (has_metadata())
     {
@@ -79,7 +110,7 @@ void FileNode::unshare(bool recursive)
     Q_UNUSED(recursive);
     if (!m_active) return;
     qDebug() << indention() << "unshare file: " << filename();
-    m_active = false;
+    set_active(false);
 
     if (has_transfer())
     {
@@ -97,7 +128,7 @@ void FileNode::unshare(bool recursive)
 
 void FileNode::on_transfer_finished(Transfer t)
 {
-    m_active = true;
+    set_active(true);
     m_hash = t.hash();
     m_error = libed2k::errors::no_error;
     m_parent->drop_transfer_by_file();
@@ -114,7 +145,7 @@ void FileNode::on_transfer_finished(Transfer t)
 
 void FileNode::on_transfer_deleted()
 {
-    m_active = false;
+    set_active(false);
     m_hash.clear();
     m_parent->drop_transfer_by_file();
     Session::instance()->signal_changeNode(this);
@@ -141,7 +172,7 @@ bool FileNode::on_metadata_completed(const libed2k::add_transfer_params& atp, co
         // parameters possibly were cancelled or completed with errors
         delete m_atp;
         m_atp = NULL;
-        m_active = false;
+        set_active(false);
 
         if (has_transfer())
         {
@@ -175,45 +206,52 @@ QString correct_path(QString fullPath)
 
 QString FileNode::filepath() const
 {
-    QStringList path;
-    const DirNode* parent = m_parent;
-    path << m_filename;
-
-    while(parent && !parent->is_root())
+    if (m_filepath.isNull())
     {
-        path.prepend(parent->filename());
-        parent = parent->m_parent;
+        if (m_parent && !m_parent->is_root())
+        {
+            // parent path is already corrected, only drive or unix root ends with separator
+            QString parent = m_parent->filepath();
+
+            if (parent.endsWith(QLatin1Char('/')))
+                m_filepath = parent + QDir::fromNativeSeparators(m_filename);
+            else
+                m_filepath = parent + QLatin1Char('/') + QDir::fromNativeSeparators(m_filename);
+        }
+        else
+        {
+            m_filepath = correct_path(QDir::fromNativeSeparators(m_filename));
+        }
     }
 
-    return correct_path(QDir::fromNativeSeparators(path.join(QDir::separator())));
+    return m_filepath;
 }
 
 QString FileNode::parent_path() const
 {
-    QStringList path;
-    const DirNode* parent = m_parent;
-
-    while(parent && !parent->is_root())
+    if (m_parent && !m_parent->is_root())
     {
-        path.prepend(parent->filename());
-        parent = parent->m_parent;
+        return m_parent->filepath();
     }
 
-    return correct_path(QDir::fromNativeSeparators(path.join(QDir::separator())));
+    return QString("");
 }
 
 int FileNode::level() const
 {
-    int level = 0;
-    const DirNode* parent = m_parent;
+    return m_level;
+}
 
-    while(parent && !parent->is_root())
-    {
-        ++level;
-        parent = parent->m_parent;
-    }
+void FileNode::set_filename(const QString& filename)
+{
+    m_filename = filename;
+    m_sort_key = naturalKey(m_filename);
+    invalidate_path();
+}
 
-    return level;
+void FileNode::invalidate_path()
+{
+    m_filepath = QString();
 }
 
 QString FileNode::indention() const
@@ -244,7 +282,9 @@ QString FileNode::string() const
 DirNode::DirNode(DirNode* parent, const QFileInfo& info, bool root /*= false*/) :
     FileNode(parent, info),
     m_populated(false),
-    m_root(root)
+    m_root(root),
+    m_active_children(0),
+    m_complete_children(0)
 {
 }
 
@@ -254,28 +294,17 @@ DirNode::~DirNode()
     foreach(DirNode* p, m_dir_children.values()) { delete p; }
 }
 
-void DirNode::share(bool recursive)
+void DirNode::invalidate_path()
 {
-    if (!m_active)
-    {
-        m_active = true;
-        Session::instance()->addDirectory(this);
-
-        // execute without check current state
-        // we can re-share files were unshared after directory was shared        
-        populate(true);  // re-scan directory
+    FileNode::invalidate_path();
 
-        foreach(FileNode* p, m_file_children.values())
-        {
-            p->share(recursive);
-        }
+    foreach(FileNode* p, m_file_children) { p->invalidate_path(); }
+    foreach(DirNode* p, m_dir_children) { p->invalidate_path(); }
+}
 
-        // update state on all children
-        foreach(DirNode* p, m_dir_children.values())
-        {
-            p->update_state();
-        }
-    }
+void DirNode::share(bool recursive)
+{
+    share_node();
 
     if (recursive)
     {
@@ -292,29 +321,7 @@ void DirNode::share(bool recursive)
 
 void DirNode::unshare(bool recursive)
 {
-    qDebug() << indention() << "unshare dir: " << filename();
-
-    if (m_active)
-    {
-        m_active = false;
-        Session::instance()->removeDirectory(this);
-
-        deleteTransfer();
-
-        foreach(FileNode* p, m_file_children.values())
-        {
-            p->unshare(recursive);
-        }
-
-        // on non-recursive we update state because current node state was changed
-        if (!recursive)
-        {
-            foreach(DirNode* p, m_dir_children.values())
-            {
-                p->update_state();
-            }
-        }
-    }
+    unshare_node(recursive);
 
     if (recursive)
     {
@@ -327,63 +334,73 @@ void DirNode::unshare(bool recursive)
     Session::instance()->signal_changeNode(this);
 }
 
-void DirNode::deleteTransfer()
+void DirNode::share_node()
 {
-    if (has_transfer())
+    if (m_active) return;
+
+    set_active(true);
+    Session::instance()->addDirectory(this);
+
+    // execute without check current state
+    // we can re-share files were unshared after directory was shared
+    populate(true);  // re-scan directory
+
+    foreach(FileNode* p, m_file_children.values())
     {
-        Session::instance()->get_ed2k_session()->deleteTransfer(m_hash, true);
-        m_hash.clear();
+        p->share(false);
+    }
+
+    // update state on all children
+    foreach(DirNode* p, m_dir_children.values())
+    {
+        p->update_state();
     }
 }
 
-bool DirNode::contains_active_children() const
+void DirNode::unshare_node(bool recursive)
 {
-    bool active = m_active;
+    qDebug() << indention() << "unshare dir: " << filename();
+    if (!m_active) return;
+
+    set_active(false);
+    Session::instance()->removeDirectory(this);
+
+    deleteTransfer();
 
-    if (!active)
+    foreach(FileNode* p, m_file_children.values())
     {
-        foreach(const FileNode* node, m_file_children)
-        {
-            active = node->contains_active_children();
-            if (active) break;
-        }
+        p->unshare(recursive);
+    }
 
-        if (!active)
+    // on non-recursive we update state because current node state was changed
+    if (!recursive)
+    {
+        foreach(DirNode* p, m_dir_children.values())
         {
-            foreach(const DirNode* node, m_dir_children)
-            {
-                active = node->contains_active_children();
-                if (active) break;
-            }
+            p->update_state();
         }
     }
-
-    return active;
 }
 
-bool DirNode::all_active_children() const
+void DirNode::deleteTransfer()
 {
-    bool active = m_active;
+    Session::instance()->cancel_collection(this);
 
-    if (active)
+    if (has_transfer())
     {
-        foreach(const FileNode* node, m_file_children)
-        {
-            active = node->all_active_children();
-            if (!active) break;
-        }
-
-        if (active)
-        {
-            foreach(const DirNode* node, m_dir_children)
-            {
-                active = (node->is_populated() && node->all_active_children());
-                if (!active) break;
-            }
-        }
+        Session::instance()->get_ed2k_session()->deleteTransfer(m_hash, true);
+        m_hash.clear();
     }
+}
+
+bool DirNode::contains_active_children() const
+{
+    return (m_active || m_active_children > 0);
+}
 
-    return active;
+bool DirNode::all_active_children() const
+{
+    return (m_active && m_complete_children == m_file_children.size() + m_dir_children.size());
 }
 
 void DirNode::on_transfer_deleted()
@@ -422,95 +439,69 @@ void DirNode::drop_transfer_by_file()
 
 }
 
-void DirNode::build_collection()
+bool DirNode::prepare_collection(CollectionTask& task) const
 {
-    // collection would hash, but hasn't transfer yet
-    bool pending = false;
+    task.m_entries.clear();
+    task.m_entries.reserve(m_file_children.size());
 
-    int files_count = 0;
-    // check children
-    foreach(const FileNode* p, m_file_children.values())
+    foreach(const FileNode* p, m_file_children)
     {
         if (p->is_active())
         {
-            ++files_count;
-
+            // collection would hash, but hasn't transfer yet
             if (!p->has_transfer())
             {
-                pending = true;
-                break;
+                task.m_entries.clear();
+                return false;
             }
-        }
-    }
 
-    if (!pending && (files_count > 0))
-    {
-        qDebug() << "collection " << filename() << " ready";
-        QStringList lines;
+            CollectionEntry entry;
 
-        foreach(const FileNode* p, m_file_children.values())
-        {
-            if (p->is_active())
+            if (p->m_atp)
             {
-                QString line = p->string();
-                Q_ASSERT(!line.isEmpty());
-                lines << line;
-            }
-        }
-
-        int iteration = 0;
-        // generate unique filename
-        QDir cd(misc::ED2KCollectionLocation());
-        QString collection_filepath;
-
-        while(collection_filepath.isEmpty())
-        {
-            QString filename = collection_name() + (iteration?(QString("_") + QString::number(iteration)):QString()) + QString("-") + QString::number(lines.count()) + QString(".emulecollection");
-            QFileInfo fi(cd.filePath(filename));
-
-            if (fi.exists())
-            {
-                ++iteration;
+                entry.m_filename = libed2k::filename(p->m_atp->file_path);
+                entry.m_filesize = p->m_atp->file_size;
+                entry.m_hash = p->m_atp->file_hash;
             }
             else
             {
-                collection_filepath = fi.absoluteFilePath();
+                // keeps place of file as FileNode::string does
+                entry.m_filesize = 0;
+                entry.m_pending = p->m_hash;
             }
+
+            task.m_entries.push_back(entry);
         }
+    }
 
-        qDebug() << "collection filepath " << collection_filepath;
+    if (task.m_entries.empty()) return false;
 
-        QFile data(collection_filepath);
+    qDebug() << "collection " << filename() << " ready";
+    task.m_node = this;
+    task.m_name = collection_name();
+    task.m_location = misc::ED2KCollectionLocation();
+    return true;
+}
 
-        if (data.open(QFile::WriteOnly | QFile::Truncate))
-        {
-             QTextStream out(&data);
-
-             foreach(const QString& line, lines)
-             {
-                 out << line << "\n";
-             }
-
-             data.close();
-
-             // hash file and add node
-             std::pair<libed2k::add_transfer_params, libed2k::error_code> res_pair = Session::instance()->get_ed2k_session()->makeTransferParameters(collection_filepath);
-
-             if (!res_pair.second)
-             {               
-                try
-                {
-                    res_pair.first.duplicate_is_error = true;
-                    m_hash = Session::instance()->get_ed2k_session()->addTransfer(res_pair.first).hash();
-                    m_error = libed2k::errors::no_error;
-                }
-                catch(const libed2k::libed2k_exception& e)
-                {
-                    m_error = e.error();
-                    m_active = false;
-                }
-             }
-        }
+void DirNode::on_collection_ready(const libed2k::add_transfer_params& atp, const libed2k::error_code& ec)
+{
+    if (ec)
+    {
+        m_error = ec;
+        return;
+    }
+
+    try
+    {
+        libed2k::add_transfer_params params = atp;
+        params.duplicate_is_error = true;
+        m_hash = Session::instance()->get_ed2k_session()->addTransfer(params).hash();
+        m_error = libed2k::errors::no_error;
+    }
+    catch(const libed2k::libed2k_exception& e)
+    {
+        m_error = e.error();
+        set_active(false);
     }
 }
 
@@ -547,39 +538,84 @@ FileNode* DirNode::child(const QString& filename)
 
 void DirNode::add_node(FileNode* node)
 {
-    if (m_populated) Session::instance()->signal_beginInsertNode(node);
+    add_nodes(QList<FileNode*>() << node);
+}
+
+void DirNode::add_nodes(const QList<FileNode*>& nodes)
+{
+    QList<FileNode*> dirs;
+    QList<FileNode*> files;
 
-    if (node->is_dir())
+    foreach(FileNode* node, nodes)
     {
-        m_dir_children.insert(node->filename(), static_cast<DirNode*>(node));
-        m_dir_vector.push_back(static_cast<DirNode*>(node));
+        if (node->is_dir())
+            dirs << node;
+        else
+            files << node;
     }
-    else
+
+    insert_range(dirs, true);
+    insert_range(files, false);
+}
+
+void DirNode::insert_range(const QList<FileNode*>& nodes, bool dirs)
+{
+    if (nodes.isEmpty()) return;
+    if (m_populated) Session::instance()->signal_beginInsertNodes(this, dirs, nodes.size());
+
+    foreach(FileNode* node, nodes)
     {
-        m_file_children.insert(node->filename(), node);        
-        m_file_vector.push_back(node);
+        if (dirs)
+        {
+            node->m_row = m_dir_vector.size();
+            m_dir_children.insert(node->filename(), static_cast<DirNode*>(node));
+            m_dir_vector.push_back(static_cast<DirNode*>(node));
+        }
+        else
+        {
+            node->m_row = m_file_vector.size();
+            m_file_children.insert(node->filename(), node);
+            m_file_vector.push_back(node);
+        }
+
+        if (node->m_reported_active) ++m_active_children;
+        if (node->m_reported_complete) ++m_complete_children;
     }
 
-    if (m_populated) Session::instance()->signal_endInsertNode();
+    update_aggregates();
+
+    if (m_populated) Session::instance()->signal_endInsertNodes();
 }
 
 void DirNode::delete_node(const FileNode* node)
 {
+    // deliver pending changes while node and its children are alive
+    Session::instance()->flush_changes();
+
     if (m_populated) Session::instance()->signal_beginRemoveNode(node);
 
+    // shift rows of following siblings
     if (node->is_dir())
     {
-        m_dir_vector.erase(std::remove(m_dir_vector.begin(), m_dir_vector.end(), node), m_dir_vector.end());
+        Session::instance()->deleteDirectory(static_cast<const DirNode*>(node));
+        Q_ASSERT(m_dir_vector.at(node->m_row) == node);
+        m_dir_vector.removeAt(node->m_row);
+        for (int i = node->m_row; i < m_dir_vector.size(); ++i) m_dir_vector[i]->m_row = i;
         Session::instance()->removeDirectory((DirNode*)node);
         m_dir_children.take(node->filename());
     }
     else
     {
-        m_file_vector.erase(std::remove(m_file_vector.begin(), m_file_vector.end(), node), m_file_vector.end());
+        Q_ASSERT(m_file_vector.at(node->m_row) == node);
+        m_file_vector.removeAt(node->m_row);
+        for (int i = node->m_row; i < m_file_vector.size(); ++i) m_file_vector[i]->m_row = i;
         m_file_children.take(node->filename());
     }
 
+    if (node->m_reported_active) --m_active_children;
+    if (node->m_reported_complete) --m_complete_children;
     delete node;
+    update_aggregates();
 
     if (m_populated) Session::instance()->signal_endRemoveNode();
 }
@@ -608,6 +644,9 @@ void DirNode::populate(bool force /* = false*/)
 
     QString path = filepath();
 
+    // new nodes are inserted at once after scan
+    QList<FileNode*> new_nodes;
+
     if (path.isEmpty())
     {
         foreach(const QFileInfo& fi, QDir::drives())
@@ -615,10 +654,12 @@ void DirNode::populate(bool force /* = false*/)
             if (!m_dir_children.contains(translateDriveName(fi)))
             {
                 DirNode* p = new DirNode(this, fi);
-                p->m_filename = translateDriveName(fi);
-                add_node(p);
+                p->set_filename(translateDriveName(fi));
+                new_nodes << p;
             }
         }
+
+        add_nodes(new_nodes);
     }
     else
     {
@@ -647,18 +688,20 @@ void DirNode::populate(bool force /* = false*/)
 
             if (fileInfo.isDir() && !m_dir_children.contains(fileInfo.fileName()))
             {
-                add_node(new DirNode(this, fileInfo));
+                new_nodes << new DirNode(this, fileInfo);
                 continue;
             }
 
             if (fileInfo.isFile() && !m_file_children.contains(fileInfo.fileName()) &&
                 !incompleteFiles.contains(fileInfo.filePath()))
             {
-                add_node(new FileNode(this, fileInfo));
+                new_nodes << new FileNode(this, fileInfo);
                 continue;
             }
         }
 
+        add_nodes(new_nodes);
+
         // remove erased files/nodes
         // it we have transfer on removed file - unshare it
         foreach(FileNode* p, current_files.values())
@@ -669,4 +712,5 @@ void DirNode::populate(bool force /* = false*/)
     }
 
     m_populated = true;
+    update_aggregates();
 }
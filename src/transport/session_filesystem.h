@@ -8,7 +8,6 @@
 #include <QDateTime>
 #include <QFile>
 #include <QIcon>
-#include <QFileIconProvider>
 #include <QDir>
 #include <QTimer>
 #include <QDebug>
@@ -19,6 +18,7 @@
 
 class DirNode;
 class Transfer;
+struct CollectionTask;
 
 class FileNode
 {
@@ -46,24 +46,55 @@ public:
     virtual bool is_active() const { return m_active; }
     virtual bool contains_active_children() const { return m_active; }
     virtual bool all_active_children() const { return m_active; }
+
+    /**
+      * node and all its descendants are active, directory must be populated
+     */
+    virtual bool is_complete() const { return m_active; }
     QString hash() const { return m_hash; }
     int level() const;
     QString indention() const;
 
     QString string() const;
     QString filename() const { return m_filename; }
+    const QString& sort_key() const { return m_sort_key; }
+
+    /**
+      * rename node and drop cached paths of node and all descendants
+     */
+    void set_filename(const QString& filename);
     void create_transfer();
     virtual qint64 size_on_disk() const { return m_info.size(); }
 
+    /**
+      * reset cached filepath, path builds again on next request
+     */
+    virtual void invalidate_path();
+
+    /**
+      * change active flag and propagate aggregates to parents
+     */
+    void set_active(bool active);
+
+    /**
+      * recalculate node state and update parent counters when it was changed
+     */
+    void update_aggregates();
+
     DirNode*    m_parent;
     bool        m_active;
     QFileInfo   m_info;
     libed2k::add_transfer_params* m_atp;
     libed2k::error_code  m_error;
-    QIcon       m_icon;
-    QString     m_displayType;
     QString     m_hash;
     QString     m_filename;
+    bool        m_reported_active;      // contains_active_children value counted in parent
+    bool        m_reported_complete;    // is_complete value counted in parent
+    int         m_row;      // position in parent's directories or files vector
+private:
+    int             m_level;    // depth from root, nodes never change parent
+    mutable QString m_filepath; // cached full path, null when not calculated yet
+    QString         m_sort_key; // natural sort key of filename
 };
 
 class DirNode : public FileNode
@@ -77,9 +108,17 @@ public:
     virtual int children() const { return m_file_children.count(); }
     virtual bool contains_active_children() const;
     virtual bool all_active_children() const;
+    virtual bool is_complete() const { return m_populated && all_active_children(); }
 
     virtual void share(bool recursive);
     virtual void unshare(bool recursive);
+
+    /**
+      * share/unshare directory itself without recursion into sub directories
+      * used by share transaction which walks sub directories by itself
+     */
+    void share_node();
+    void unshare_node(bool recursive);
     void deleteTransfer();
 
     // signal handlers
@@ -89,9 +128,15 @@ public:
     QString collection_name() const;
     FileNode* child(const QString& filename);
     void add_node(FileNode* node);
+
+    /**
+      * insert nodes with one model notification for directories and one for files
+     */
+    void add_nodes(const QList<FileNode*>& nodes);
     void delete_node(const FileNode* node);
     QStringList exclude_files() const;
     virtual qint64 size_on_disk() const { return 0; }
+    virtual void invalidate_path();
 
     /**
       * pupulate directory with items no_share status
@@ -112,9 +157,15 @@ public:
     void drop_transfer_by_file();
 
     /**
-      * prepare collection file and add transfer based on it
+      * fill collection snapshot for background builder
+      * returns false when collection is empty or some files are hashing yet
+     */
+    bool prepare_collection(CollectionTask& task) const;
+
+    /**
+      * add transfer on collection file were built by background builder
      */
-    void build_collection();
+    void on_collection_ready(const libed2k::add_transfer_params& atp, const libed2k::error_code& ec);
 
     bool                        m_populated;
     bool                        m_root;
@@ -122,6 +173,10 @@ public:
     QHash<QString, DirNode*>    m_dir_children;
     QList<FileNode*>            m_file_vector;
     QList<DirNode*>             m_dir_vector;
+    int                         m_active_children;      // children contain active nodes
+    int                         m_complete_children;    // children are active completely
+private:
+    void insert_range(const QList<FileNode*>& nodes, bool dirs);
 };
 
 
@@ -0,0 +1,208 @@
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QThread>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QFile>
+#include <QRegExp>
+#include <QDebug>
+
+#include "session_log.h"
+
+static struct { const char *source; const char *comment; } messages[] = {
+    { 0, 0 },
+    QT_TRANSLATE_NOOP3("QBtSession", "<font color='red'>%1</font> <i>was blocked due to your IP filter</i>", "x.y.z.w was blocked"),
+    QT_TRANSLATE_NOOP3("QBtSession", "<font color='red'>%1</font> <i>was banned due to corrupt pieces</i>", "x.y.z.w was banned")
+};
+
+static const char* levels[] = { "I", "N", "C" };
+static const char* sources[] = { "app", "torrent", "ed2k" };
+
+/**
+  * appends records to file as plain text lines, queue is written in batches
+  * records queued before destruction are written
+ */
+class LogFileSink : public QThread
+{
+public:
+    LogFileSink(const QString& path) : m_file(path), m_abort(false) {}
+    ~LogFileSink();
+
+    bool open() { return m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text); }
+    void enqueue(const LogRecord& record);
+protected:
+    void run();
+private:
+    QFile               m_file;
+    bool                m_abort;
+    QWaitCondition      m_cond;
+    QMutex              m_mutex;
+    QVector<LogRecord>  m_queue;
+};
+
+LogFileSink::~LogFileSink()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_abort = true;
+        m_cond.wakeOne();
+    }
+
+    wait();
+}
+
+void LogFileSink::enqueue(const LogRecord& record)
+{
+    QMutexLocker locker(&m_mutex);
+    m_queue.append(record);
+    m_cond.wakeOne();
+}
+
+void LogFileSink::run()
+{
+    forever
+    {
+        QVector<LogRecord> batch;
+
+        {
+            QMutexLocker locker(&m_mutex);
+
+            while (m_queue.isEmpty() && !m_abort)
+                m_cond.wait(&m_mutex);
+
+            if (m_queue.isEmpty()) break;
+            batch.swap(m_queue);
+        }
+
+        QByteArray data;
+
+        foreach(const LogRecord& record, batch)
+        {
+            data += levels[record.m_level];
+            data += ' ';
+            data += sources[record.m_source];
+            data += ' ';
+            data += SessionLog::text(record).toUtf8();
+            data += '\n';
+        }
+
+        if (m_file.write(data) == -1)
+            qDebug() << "log file write failed " << m_file.errorString();
+
+        m_file.flush();
+    }
+}
+
+LogRecord::LogRecord() : m_time(0), m_level(L_INFO), m_source(S_APPLICATION), m_message(M_TEXT), m_color(0)
+{
+}
+
+LogRecord::LogRecord(Source source, Level level, Message message, const QString& arg, QRgb color /*= 0*/) :
+    m_time(QDateTime::currentMSecsSinceEpoch()), m_level(level), m_source(source), m_message(message),
+    m_arg(arg), m_color(color)
+{
+}
+
+LogRing::LogRing(int capacity) : m_records(capacity), m_head(0), m_size(0), m_total(0)
+{
+    Q_ASSERT(capacity > 0);
+}
+
+void LogRing::append(const LogRecord& record)
+{
+    if (m_size < m_records.size())
+    {
+        m_records[(m_head + m_size) % m_records.size()] = record;
+        ++m_size;
+    }
+    else
+    {
+        m_records[m_head] = record;
+        m_head = (m_head + 1) % m_records.size();
+    }
+
+    ++m_total;
+}
+
+SessionLog* SessionLog::m_instance = NULL;
+
+SessionLog* SessionLog::instance()
+{
+    if (!m_instance)
+        m_instance = new SessionLog();
+
+    return m_instance;
+}
+
+void SessionLog::drop()
+{
+    delete m_instance;
+    m_instance = NULL;
+}
+
+SessionLog::SessionLog() : m_console(MAX_LOG_MESSAGES), m_ban(MAX_LOG_MESSAGES), m_changed(0)
+{
+}
+
+SessionLog::~SessionLog()
+{
+}
+
+void SessionLog::add(Journal journal, const LogRecord& record)
+{
+    if (journal == J_CONSOLE)
+        m_console.append(record);
+    else
+        m_ban.append(record);
+
+    if (m_sink) m_sink->enqueue(record);
+
+    if (!m_changed) QMetaObject::invokeMethod(this, "notify", Qt::QueuedConnection);
+    m_changed |= 1 << journal;
+}
+
+bool SessionLog::setFileSink(const QString& path)
+{
+    m_sink.reset();
+    if (path.isEmpty()) return true;
+
+    QScopedPointer<LogFileSink> sink(new LogFileSink(path));
+
+    if (!sink->open())
+    {
+        qDebug() << "unable to open log file " << path;
+        return false;
+    }
+
+    sink->start(QThread::LowestPriority);
+    m_sink.swap(sink);
+    return true;
+}
+
+QString SessionLog::html(const LogRecord& record)
+{
+    QString res = "<font color='grey'>" + QDateTime::fromMSecsSinceEpoch(record.m_time).toString(QString::fromUtf8("dd/MM/yyyy hh:mm:ss")) + "</font> - ";
+
+    if (record.m_message != LogRecord::M_TEXT)
+        return res + QCoreApplication::translate("QBtSession", messages[record.m_message].source, messages[record.m_message].comment).arg(record.m_arg);
+
+    if (record.m_color)
+        return res + "<font color='" + QColor(record.m_color).name() + "'><i>" + record.m_arg + "</i></font>";
+
+    return res + "<i>" + record.m_arg + "</i>";
+}
+
+QString SessionLog::text(const LogRecord& record)
+{
+    return html(record).remove(QRegExp("<[^>]+>"));
+}
+
+void SessionLog::notify()
+{
+    int changed = m_changed;
+    m_changed = 0;
+
+    if (changed & (1 << J_CONSOLE)) emit recordsAdded(J_CONSOLE);
+    if (changed & (1 << J_BAN)) emit recordsAdded(J_BAN);
+}
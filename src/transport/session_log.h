@@ -0,0 +1,123 @@
+#ifndef __SESSION_LOG__
+#define __SESSION_LOG__
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QColor>
+#include <QScopedPointer>
+
+const int MAX_LOG_MESSAGES = 100;
+
+/**
+  * structured log record, text and html are produced only when record is shown or written
+ */
+struct LogRecord
+{
+    enum Level
+    {
+        L_INFO,
+        L_NOTICE,
+        L_CRITICAL
+    };
+
+    enum Source
+    {
+        S_APPLICATION,
+        S_TORRENT,
+        S_ED2K
+    };
+
+    enum Message
+    {
+        M_TEXT,         // argument is translated text
+        M_IP_BLOCKED,   // argument is ip blocked by ip filter
+        M_PEER_BANNED   // argument is ip banned due to corrupt pieces
+    };
+
+    LogRecord();
+    /**
+      * record stamped with current time
+     */
+    LogRecord(Source source, Level level, Message message, const QString& arg, QRgb color = 0);
+
+    qint64  m_time;     // msecs since epoch
+    Level   m_level;
+    Source  m_source;
+    Message m_message;
+    QString m_arg;
+    QRgb    m_color;    // color of M_TEXT, 0 for default text color
+};
+
+/**
+  * fixed capacity ring of records, oldest record is overwritten when ring is full
+ */
+class LogRing
+{
+public:
+    LogRing(int capacity);
+
+    void append(const LogRecord& record);
+
+    int size() const { return m_size; }
+    int capacity() const { return m_records.size(); }
+    /**
+      * at(0) is the oldest record in ring
+     */
+    const LogRecord& at(int index) const { return m_records.at((m_head + index) % m_records.size()); }
+    /**
+      * count of records ever appended, views compare it with own counter to find new records
+     */
+    quint64 total() const { return m_total; }
+private:
+    QVector<LogRecord>  m_records;
+    int                 m_head;
+    int                 m_size;
+    quint64             m_total;
+};
+
+class LogFileSink;
+
+/**
+  * console and peer ban journals of application with optional copy to file
+  * records are added on main thread, views are notified once per event loop iteration
+ */
+class SessionLog : public QObject
+{
+    Q_OBJECT
+public:
+    enum Journal
+    {
+        J_CONSOLE,
+        J_BAN
+    };
+
+    static SessionLog* instance();
+    static void drop();
+
+    void add(Journal journal, const LogRecord& record);
+    const LogRing& journal(Journal journal) const { return (journal == J_CONSOLE)?m_console:m_ban; }
+
+    /**
+      * append records of both journals to file on worker thread, empty path stops writing
+     */
+    bool setFileSink(const QString& path);
+
+    static QString html(const LogRecord& record);
+    static QString text(const LogRecord& record);
+signals:
+    void recordsAdded(int journal);
+private slots:
+    void notify();
+private:
+    SessionLog();
+    ~SessionLog();
+
+    static SessionLog*  m_instance;
+    LogRing             m_console;
+    LogRing             m_ban;
+    int                 m_changed;  // bits of journals changed since last notify
+    QScopedPointer<LogFileSink> m_sink;
+};
+
+#endif //__SESSION_LOG__
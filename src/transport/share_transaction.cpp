@@ -0,0 +1,78 @@
+#include <QTime>
+#include <QDebug>
+
+#include "share_transaction.h"
+#include "session.h"
+
+ShareTransaction::ShareTransaction(DirNode* node, bool share, QObject* parent /*= 0*/) :
+    QObject(parent), m_share(share), m_dirs(0), m_files(0)
+{
+    m_pending << node;
+    m_timer.setInterval(0);
+    connect(&m_timer, SIGNAL(timeout()), this, SLOT(on_step()));
+}
+
+void ShareTransaction::start()
+{
+    qDebug() << (m_share?"share":"unshare") << " transaction started on " << m_pending.first()->filepath();
+    m_timer.start();
+}
+
+void ShareTransaction::cancel()
+{
+    if (!m_timer.isActive()) return;
+    qDebug() << "transaction cancelled, pending directories " << m_pending.size();
+    m_timer.stop();
+    m_pending.clear();
+    emit finished();
+}
+
+void ShareTransaction::removeDirectory(const DirNode* dir)
+{
+    QList<DirNode*>::iterator itr = m_pending.begin();
+
+    while (itr != m_pending.end())
+    {
+        const FileNode* p = *itr;
+        while (p && p != dir) p = p->m_parent;
+
+        if (p)
+            itr = m_pending.erase(itr);
+        else
+            ++itr;
+    }
+}
+
+void ShareTransaction::on_step()
+{
+    QTime t;
+    t.start();
+
+    while (!m_pending.isEmpty() && t.elapsed() < step_duration)
+    {
+        DirNode* dir = m_pending.takeLast();
+
+        if (m_share)
+            dir->share_node();
+        else
+            dir->unshare_node(true);
+
+        Session::instance()->signal_changeNode(dir);
+        ++m_dirs;
+        m_files += dir->m_file_vector.size();
+
+        foreach(DirNode* child, dir->m_dir_vector)
+        {
+            m_pending << child;
+        }
+    }
+
+    emit progress(m_dirs, m_files);
+
+    if (m_pending.isEmpty())
+    {
+        qDebug() << "transaction completed, directories " << m_dirs << " files " << m_files;
+        m_timer.stop();
+        emit finished();
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef __SHARE_TRANSACTION__
+#define __SHARE_TRANSACTION__
+
+#include <QObject>
+#include <QTimer>
+#include <QList>
+
+class DirNode;
+
+/**
+  * recursive share/unshare of directory tree
+  * executes by small steps from event loop, so gui is responsive and operation can be cancelled
+  * session removes deleted directories from pending stack, so nodes stay valid between steps
+ */
+class ShareTransaction : public QObject
+{
+    Q_OBJECT
+public:
+    ShareTransaction(DirNode* node, bool share, QObject* parent = 0);
+    void start();
+    bool is_share() const { return m_share; }
+    /**
+      * forget pending directory and its subdirectories before they are deleted
+     */
+    void removeDirectory(const DirNode* dir);
+public slots:
+    void cancel();
+signals:
+    void progress(int dirs, int files);
+    void finished();
+private slots:
+    void on_step();
+private:
+    static const int step_duration = 50; // ms
+
+    bool        m_share;
+    QTimer      m_timer;
+    QList<DirNode*> m_pending;  // directories stack
+    int         m_dirs;
+    int         m_files;
+};
+
+#endif //__SHARE_TRANSACTION__
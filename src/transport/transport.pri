@@ -4,10 +4,18 @@ HEADERS += $$PWD/session_base.h \
            $$PWD/session.h \
            $$PWD/transfer.h \
            $$PWD/transfer_base.h \
-           $$PWD/session_filesystem.h
+           $$PWD/session_filesystem.h \
+           $$PWD/collection_builder.h \
+           $$PWD/share_transaction.h \
+           $$PWD/file_name_index.h \
+           $$PWD/session_log.h
 
 SOURCES += $$PWD/session_base.cpp \
            $$PWD/session.cpp \
            $$PWD/transfer.cpp \
            $$PWD/transfer_base.cpp \
-           $$PWD/session_filesystem.cpp
+           $$PWD/session_filesystem.cpp \
+           $$PWD/collection_builder.cpp \
+           $$PWD/share_transaction.cpp \
+           $$PWD/file_name_index.cpp \
+           $$PWD/session_log.cpp
@@ -0,0 +1,15 @@
+QT       += core
+
+QT       -= gui
+
+TARGET = file_name_index
+CONFIG   += console qtestlib
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/transport
+
+HEADERS += ../../src/transport/file_name_index.h
+SOURCES += main.cpp \
+           ../../src/transport/file_name_index.cpp
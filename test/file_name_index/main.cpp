@@ -0,0 +1,127 @@
+#include <QtTest/QTest>
+#include <QStringList>
+#include <QVector>
+
+#include "file_name_index.h"
+
+struct File
+{
+    QString m_hash;
+    QString m_name;
+};
+
+QVector<File> generate(int count)
+{
+    static const char* words[] = { "Movie", "track", "Season", "photo", "report", "Backup", "episode", "disk" };
+    static const char* exts[] = { ".avi", ".mp3", ".jpg", ".pdf", ".iso", ".zip" };
+    QVector<File> res(count);
+    qsrand(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        res[i].m_hash = QString("%1").arg(i, 32, 16, QChar('0'));
+        res[i].m_name = QString("%1_%2 part %3.%4%5")
+               .arg(words[qrand() % 8])
+               .arg(qrand() % 1000)
+               .arg(qrand() % 100)
+               .arg(words[qrand() % 8])
+               .arg(exts[qrand() % 6]);
+    }
+
+    return res;
+}
+
+// every query word is prefix of some name word, as index matches
+QSet<QString> scan(const QVector<File>& files, const QString& query)
+{
+    QStringList query_words = FileNameIndex::words(query);
+    QSet<QString> res;
+
+    foreach(const File& f, files)
+    {
+        QStringList name_words = FileNameIndex::words(f.m_name);
+        bool matched = !query_words.isEmpty();
+
+        foreach(const QString& qw, query_words)
+        {
+            bool found = false;
+            foreach(const QString& nw, name_words)
+                if (nw.startsWith(qw)) { found = true; break; }
+            if (!found) { matched = false; break; }
+        }
+
+        if (matched) res.insert(f.m_hash);
+    }
+
+    return res;
+}
+
+class FileNameIndexTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void words()
+    {
+        QCOMPARE(FileNameIndex::words("Movie_12 part 3.Movie.AVI"),
+                 QStringList() << "movie" << "12" << "part" << "3" << "avi");
+        QVERIFY(FileNameIndex::words(" .-_ ").isEmpty());
+    }
+
+    void match_data()
+    {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<QString>("query");
+
+        foreach(int count, QList<int>() << 10000 << 100000)
+        {
+            foreach(const QString& q, QStringList() << "movie" << "seas 12" << "track 7 avi" << "ep" << "backup zip" << "nothing" << "")
+            {
+                QTest::newRow(qPrintable(QString("%1 %2").arg(count).arg(q))) << count << q;
+            }
+        }
+    }
+
+    void match()
+    {
+        QFETCH(int, count);
+        QFETCH(QString, query);
+        QVector<File> files = generate(count);
+        FileNameIndex index;
+
+        foreach(const File& f, files)
+            index.add(f.m_hash, f.m_name);
+
+        QCOMPARE(index.size(), count);
+        QSet<QString> found;
+        QBENCHMARK_ONCE { found = index.match(query); }
+        QCOMPARE(found, scan(files, query));
+    }
+
+    void remove()
+    {
+        QVector<File> files = generate(1000);
+        FileNameIndex index;
+
+        foreach(const File& f, files)
+            index.add(f.m_hash, f.m_name);
+
+        // removal drops words of last reference only
+        index.add(files.first().m_hash, files.first().m_name);
+        index.remove(files.first().m_hash);
+        QVERIFY(index.contains(files.first().m_hash));
+        index.remove(files.first().m_hash);
+        QVERIFY(!index.contains(files.first().m_hash));
+        QCOMPARE(index.size(), files.size() - 1);
+
+        files.remove(0);
+        QCOMPARE(index.match("movie"), scan(files, "movie"));
+
+        index.clear();
+        QCOMPARE(index.size(), 0);
+        QVERIFY(index.match("movie").isEmpty());
+    }
+};
+
+QTEST_MAIN(FileNameIndexTest)
+
+#include "main.moc"
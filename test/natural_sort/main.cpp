@@ -0,0 +1,180 @@
+#include <QtTest/QTest>
+#include <QStringList>
+#include <QVector>
+#include <QTime>
+#include <QDebug>
+#include <algorithm>
+
+#include "natural_sort.h"
+
+static int sign(int v)
+{
+    return (v > 0) - (v < 0);
+}
+
+// order of strings by keys, ties are broken as proxies do
+static int keyCompare(const QString& s1, const QString& s2)
+{
+    int res = naturalKeyCompare(naturalKey(s1), naturalKey(s2));
+    if (res == 0) res = QString::compare(s1, s2, Qt::CaseSensitive);
+    return sign(res);
+}
+
+// sort by naturalCompare on every comparison, as proxies did before
+struct StringLess
+{
+    bool operator()(const QString& s1, const QString& s2) const
+    {
+        return naturalCompare(s1, s2, Qt::CaseSensitive) < 0;
+    }
+};
+
+struct Entry
+{
+    QString m_name;
+    QString m_key;
+};
+
+// sort by keys were computed once per entry
+struct KeyLess
+{
+    bool operator()(const Entry* e1, const Entry* e2) const
+    {
+        int res = naturalKeyCompare(e1->m_key, e2->m_key);
+        if (res == 0) res = QString::compare(e1->m_name, e2->m_name, Qt::CaseSensitive);
+        return res < 0;
+    }
+};
+
+static QString randomString(const QString& alphabet, int max_length)
+{
+    QString res;
+    int length = qrand() % (max_length + 1);
+    for (int i = 0; i < length; ++i)
+        res += alphabet.at(qrand() % alphabet.size());
+    return res;
+}
+
+static QStringList generate(int count)
+{
+    static const char* words[] = { "Movie", "track", "Season", "photo", "report", "Backup", "episode", "disk" };
+    static const char* exts[] = { ".avi", ".mp3", ".jpg", ".pdf", ".iso", ".zip" };
+    QStringList res;
+    qsrand(count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        res << QString("%1 %2 part %3 (%4)%5")
+               .arg(words[qrand() % 8])
+               .arg(qrand() % 1000, (qrand() % 3) + 1, 10, QChar('0'))
+               .arg(qrand() % 100)
+               .arg(qrand())
+               .arg(exts[qrand() % 6]);
+    }
+
+    return res;
+}
+
+class NaturalSortTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void compare_data();
+    void compare();
+    void randomPairs();
+    void sortOrder_data();
+    void sortOrder();
+};
+
+void NaturalSortTest::compare_data()
+{
+    QTest::addColumn<QString>("s1");
+    QTest::addColumn<QString>("s2");
+
+    QTest::newRow("leading zeros") << "file 007.avi" << "file 7.avi";
+    QTest::newRow("leading zeros, longer") << "file 007.avi" << "file 10.avi";
+    QTest::newRow("zeros only") << "a00" << "a0";
+    QTest::newRow("zeros only, letter") << "a00b" << "a0b";
+    QTest::newRow("zero against digit") << "a0b" << "a1";
+    QTest::newRow("zero run then space") << "a0 d" << "a0c";
+    QTest::newRow("zero run then space, end") << "00" << "0 ";
+    QTest::newRow("trailing zero then space") << "10 x" << "10y";
+    QTest::newRow("trailing zero then tab") << "disk 20\tb" << "disk 20 a";
+    QTest::newRow("space inside number") << "1 2" << "12";
+    QTest::newRow("digit against letter") << "a5" << "ab";
+    QTest::newRow("zero against letter") << "a05" << "ab";
+    QTest::newRow("zero against superscript") << "a05" << QString::fromUtf8("a\xc2\xb3");
+    QTest::newRow("digit and letter swapped") << "x2y" << "xy2";
+    QTest::newRow("number against punctuation") << "part 01-b" << "part -1b";
+}
+
+void NaturalSortTest::compare()
+{
+    QFETCH(QString, s1);
+    QFETCH(QString, s2);
+
+    QCOMPARE(keyCompare(s1, s2), sign(naturalCompare(s1, s2, Qt::CaseSensitive)));
+    QCOMPARE(keyCompare(s2, s1), sign(naturalCompare(s2, s1, Qt::CaseSensitive)));
+}
+
+void NaturalSortTest::randomPairs()
+{
+    const QStringList alphabets = QStringList() << "00012 ab-" << "0190 \ta" << "00 19a-";
+    qsrand(1);
+
+    foreach(const QString& alphabet, alphabets)
+    {
+        for (int i = 0; i < 100000; ++i)
+        {
+            const QString s1 = randomString(alphabet, 10);
+            const QString s2 = randomString(alphabet, 10);
+            const int expected = sign(naturalCompare(s1, s2, Qt::CaseSensitive));
+            QVERIFY2(keyCompare(s1, s2) == expected,
+                     qPrintable(QString("'%1' '%2' expected %3").arg(s1, s2).arg(expected)));
+        }
+    }
+}
+
+void NaturalSortTest::sortOrder_data()
+{
+    QTest::addColumn<int>("count");
+
+    QTest::newRow("100k") << 100000;
+    QTest::newRow("1M") << 1000000;
+}
+
+// prints sort times before and after keys, both orders must be same
+void NaturalSortTest::sortOrder()
+{
+    QFETCH(int, count);
+    QStringList names = generate(count);
+    QTime t;
+
+    QStringList before = names;
+    t.start();
+    std::sort(before.begin(), before.end(), StringLess());
+    int before_ms = t.elapsed();
+
+    QVector<Entry> entries(names.size());
+    QVector<Entry*> after(names.size());
+    t.restart();
+
+    for (int i = 0; i < names.size(); ++i)
+    {
+        entries[i].m_name = names.at(i);
+        entries[i].m_key = naturalKey(names.at(i));
+        after[i] = &entries[i];
+    }
+
+    std::sort(after.begin(), after.end(), KeyLess());
+    int after_ms = t.elapsed();
+
+    qDebug() << names.size() << "entries: naturalCompare" << before_ms << "ms, keys and sort" << after_ms << "ms";
+
+    for (int i = 0; i < before.size(); ++i)
+        QCOMPARE(after.at(i)->m_name, before.at(i));
+}
+
+QTEST_MAIN(NaturalSortTest)
+
+#include "main.moc"
@@ -0,0 +1,15 @@
+QT       += core
+
+QT       -= gui
+
+TARGET = natural_sort
+CONFIG   += console qtestlib
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/natural_sort.h
+SOURCES += main.cpp \
+           ../../src/natural_sort.cpp
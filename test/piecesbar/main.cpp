@@ -0,0 +1,182 @@
+#include <QtTest/QTest>
+#include <algorithm>
+#include <cmath>
+
+#include "piecesscale.h"
+
+// resampling as pieces bars did before, every piece is visited
+// with float bounds, value(i) is weight of piece i
+template<typename Values>
+std::vector<float> reference(const Values& vecin, int size, float norm, int reqSize)
+{
+    std::vector<float> result(reqSize, 0.0);
+    if (size == 0 || norm == 0) return result;
+
+    const float ratio = size / (float)reqSize;
+
+    for (int x = 0; x < reqSize; ++x)
+    {
+        const float fromR = (x * (unsigned int)size) / (float)reqSize;
+        const float toR = ((x + 1) * (unsigned int)size) / (float)reqSize;
+        int fromC = fromR;
+        int toC = std::ceil(toR);
+        int x2 = fromC;
+        const int toCMinusOne = toC - 1;
+        float value = 0;
+
+        if (x2 == toCMinusOne)
+        {
+            value += (toR - fromR) * vecin(x2);
+            ++x2;
+        }
+        else
+        {
+            if (x2 != fromR)
+            {
+                value += (1.0 - (fromR - fromC)) * vecin(x2);
+                ++x2;
+            }
+
+            for (; x2 < toCMinusOne; ++x2)
+                value += vecin(x2);
+
+            if (x2 == toCMinusOne)
+            {
+                value += (1.0 - (toC - toR)) * vecin(x2);
+                ++x2;
+            }
+        }
+
+        value /= ratio * norm;
+        result[x] = qMin(value, (float)1.0);
+    }
+
+    return result;
+}
+
+struct BitValue
+{
+    const libtorrent::bitfield& m_bf;
+    BitValue(const libtorrent::bitfield& bf) : m_bf(bf) {}
+    int operator()(int i) const { return m_bf[i] ? 1 : 0; }
+};
+
+struct IntValue
+{
+    const std::vector<int>& m_vec;
+    IntValue(const std::vector<int>& vec) : m_vec(vec) {}
+    int operator()(int i) const { return m_vec[i]; }
+};
+
+float maxDiff(const std::vector<float>& v1, const std::vector<float>& v2)
+{
+    float res = 0;
+
+    for (size_t i = 0; i < v1.size(); ++i)
+        res = qMax(res, std::fabs(v1[i] - v2[i]));
+
+    return res;
+}
+
+// reference accumulates float bounds, new code is exact
+const float TOLERANCE = 1e-3f;
+
+class PiecesBarTest : public QObject
+{
+    Q_OBJECT
+private:
+    void generate(int pieces, libtorrent::bitfield& bf, std::vector<int>& avail)
+    {
+        qsrand(pieces);
+        bf.resize(pieces, false);
+        avail.resize(pieces);
+
+        for (int i = 0; i < pieces; ++i)
+        {
+            if (qrand() % 3) bf.set_bit(i);
+            avail[i] = qrand() % 50;
+        }
+    }
+
+    void sizes()
+    {
+        QTest::addColumn<int>("pieces");
+        QTest::addColumn<int>("width");
+
+        QTest::newRow("empty") << 0 << 997;
+        QTest::newRow("single piece") << 1 << 997;
+        QTest::newRow("more pixels than pieces") << 10 << 997;
+        QTest::newRow("more pixels, odd pieces") << 333 << 997;
+        QTest::newRow("equal") << 997 << 997;
+        QTest::newRow("pieces divisible by 8") << 1000 << 997;
+        QTest::newRow("pieces not divisible by 8") << 1003 << 997;
+        QTest::newRow("pieces not divisible by 32") << 4099 << 100;
+        QTest::newRow("many pieces") << 100000 << 997;
+        QTest::newRow("huge") << 3000000 << 997;
+    }
+private slots:
+    void bitfield_data() { sizes(); }
+    void bitfield()
+    {
+        QFETCH(int, pieces);
+        QFETCH(int, width);
+        libtorrent::bitfield bf;
+        std::vector<int> avail;
+        generate(pieces, bf, avail);
+
+        std::vector<float> after = scaleBitfield(bf, width);
+        QCOMPARE(after.size(), size_t(width));
+        float diff = maxDiff(reference(BitValue(bf), pieces, 1, width), after);
+        QVERIFY2(diff < TOLERANCE, qPrintable(QString("max diff %1").arg(diff)));
+    }
+
+    void availability_data() { sizes(); }
+    void availability()
+    {
+        QFETCH(int, pieces);
+        QFETCH(int, width);
+        libtorrent::bitfield bf;
+        std::vector<int> avail;
+        generate(pieces, bf, avail);
+
+        const int maxAvail = avail.empty() ? 0 : *std::max_element(avail.begin(), avail.end());
+        std::vector<float> after = scaleAvailability(avail, width);
+        QCOMPARE(after.size(), size_t(width));
+        float diff = maxDiff(reference(IntValue(avail), pieces, maxAvail, width), after);
+        QVERIFY2(diff < TOLERANCE, qPrintable(QString("max diff %1").arg(diff)));
+    }
+
+    void zeroAvailability()
+    {
+        std::vector<float> res = scaleAvailability(std::vector<int>(1003, 0), 997);
+        QCOMPARE(maxDiff(res, std::vector<float>(997, 0)), 0.0f);
+    }
+
+    void fullBitfield()
+    {
+        // every pixel of complete torrent is full, also with partial pieces at bounds
+        libtorrent::bitfield bf(1003, true);
+        std::vector<float> res = scaleBitfield(bf, 997);
+        QVERIFY2(maxDiff(res, std::vector<float>(997, 1)) < TOLERANCE, "full bitfield isn't full bar");
+    }
+
+    void benchBitfield()
+    {
+        libtorrent::bitfield bf;
+        std::vector<int> avail;
+        generate(3000000, bf, avail);
+        QBENCHMARK { scaleBitfield(bf, 997); }
+    }
+
+    void benchAvailability()
+    {
+        libtorrent::bitfield bf;
+        std::vector<int> avail;
+        generate(3000000, bf, avail);
+        QBENCHMARK { scaleAvailability(avail, 997); }
+    }
+};
+
+QTEST_MAIN(PiecesBarTest)
+
+#include "main.moc"
@@ -0,0 +1,17 @@
+QT       += core
+
+QT       -= gui
+
+TARGET = piecesbar
+CONFIG   += console qtestlib
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/properties
+
+HEADERS += ../../src/properties/piecesscale.h
+SOURCES += main.cpp \
+           ../../src/properties/piecesscale.cpp
+
+LIBS += -ltorrent-rasterbar
@@ -0,0 +1,165 @@
+#include <QtTest/QTest>
+#include <QStringList>
+#include <QDateTime>
+#include <QColor>
+#include <QFile>
+#include <QDir>
+
+#include "session_log.h"
+
+class Counter : public QObject
+{
+    Q_OBJECT
+public:
+    Counter() : m_console(0), m_ban(0) {}
+    int m_console;
+    int m_ban;
+public slots:
+    void on_recordsAdded(int journal)
+    {
+        if (journal == SessionLog::J_CONSOLE) ++m_console;
+        else ++m_ban;
+    }
+};
+
+// former SessionBase::addConsoleMessage
+void addEager(QStringList& messages, QString msg, QColor color)
+{
+    if (messages.size() > MAX_LOG_MESSAGES)
+    {
+        messages.removeFirst();
+    }
+
+    msg = "<font color='grey'>"+ QDateTime::currentDateTime().toString(QString::fromUtf8("dd/MM/yyyy hh:mm:ss")) + "</font> - <font color='" + color.name() + "'><i>" + msg + "</i></font>";
+    messages.append(msg);
+}
+
+LogRecord record(int i)
+{
+    return LogRecord(LogRecord::S_APPLICATION, LogRecord::L_INFO, LogRecord::M_TEXT, QString::number(i));
+}
+
+class SessionLogTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void cleanup()
+    {
+        SessionLog::drop();
+    }
+
+    void ringPartial()
+    {
+        LogRing ring(100);
+
+        for (int i = 0; i < 30; ++i)
+            ring.append(record(i));
+
+        QCOMPARE(ring.capacity(), 100);
+        QCOMPARE(ring.size(), 30);
+        QCOMPARE(ring.total(), quint64(30));
+
+        for (int i = 0; i < ring.size(); ++i)
+            QCOMPARE(ring.at(i).m_arg, QString::number(i));
+    }
+
+    void ringOverwrite()
+    {
+        LogRing ring(100);
+
+        for (int i = 0; i < 250; ++i)
+            ring.append(record(i));
+
+        QCOMPARE(ring.size(), 100);
+        QCOMPARE(ring.total(), quint64(250));
+
+        // oldest records are overwritten
+        for (int i = 0; i < ring.size(); ++i)
+            QCOMPARE(ring.at(i).m_arg, QString::number(150 + i));
+    }
+
+    void text()
+    {
+        LogRecord rec(LogRecord::S_TORRENT, LogRecord::L_CRITICAL, LogRecord::M_TEXT, "Peer was banned", QColor(Qt::red).rgb());
+        QString html = SessionLog::html(rec);
+        QVERIFY(html.contains("<font color='#ff0000'><i>Peer was banned</i></font>"));
+        QVERIFY(SessionLog::text(rec).endsWith(" - Peer was banned"));
+        QVERIFY(!SessionLog::text(rec).contains('<'));
+    }
+
+    void notifications()
+    {
+        Counter counter;
+        QObject::connect(SessionLog::instance(), SIGNAL(recordsAdded(int)), &counter, SLOT(on_recordsAdded(int)));
+
+        for (int i = 0; i < 1000; ++i)
+            SessionLog::instance()->add(SessionLog::J_CONSOLE, record(i));
+
+        SessionLog::instance()->add(SessionLog::J_BAN, record(0));
+
+        // views are notified once per event loop iteration
+        QCOMPARE(counter.m_console, 0);
+        QCoreApplication::processEvents();
+        QCOMPARE(counter.m_console, 1);
+        QCOMPARE(counter.m_ban, 1);
+
+        const LogRing& console = SessionLog::instance()->journal(SessionLog::J_CONSOLE);
+        QCOMPARE(console.size(), MAX_LOG_MESSAGES);
+        QCOMPARE(console.total(), quint64(1000));
+        QCOMPARE(console.at(console.size() - 1).m_arg, QString::number(999));
+        QCOMPARE(SessionLog::instance()->journal(SessionLog::J_BAN).size(), 1);
+    }
+
+    void fileSink()
+    {
+        const int count = 10000;
+        const QString path = QDir::temp().filePath("session_log_test.log");
+        QFile::remove(path);
+
+        QVERIFY(SessionLog::instance()->setFileSink(path));
+
+        for (int i = 0; i < count; ++i)
+            SessionLog::instance()->add((i % 2)?SessionLog::J_CONSOLE:SessionLog::J_BAN,
+                LogRecord(LogRecord::S_ED2K, LogRecord::L_NOTICE, (i % 2)?LogRecord::M_TEXT:LogRecord::M_IP_BLOCKED, QString::number(i)));
+
+        // writes queued records
+        SessionLog::drop();
+
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly | QIODevice::Text));
+        QList<QByteArray> lines = file.readAll().split('\n');
+        file.close();
+        QFile::remove(path);
+
+        QCOMPARE(lines.size(), count + 1);
+        QVERIFY(lines.last().isEmpty());
+        QVERIFY(lines.at(0).startsWith("N ed2k "));
+        QVERIFY(lines.at(0).endsWith("0 was blocked due to your IP filter"));
+        QVERIFY(lines.at(count - 1).endsWith(" - " + QByteArray::number(count - 1)));
+    }
+
+    void benchEager()
+    {
+        QStringList messages;
+        const QColor color(Qt::red);
+        int i = 0;
+
+        QBENCHMARK { addEager(messages, QString("Peer %1 was banned").arg(i++), color); }
+    }
+
+    void benchRing()
+    {
+        const QColor color(Qt::red);
+        int i = 0;
+
+        QBENCHMARK
+        {
+            SessionLog::instance()->add(SessionLog::J_CONSOLE,
+                LogRecord(LogRecord::S_TORRENT, LogRecord::L_CRITICAL, LogRecord::M_TEXT, QString("Peer %1 was banned").arg(i++), color.rgb()));
+        }
+    }
+};
+
+QTEST_MAIN(SessionLogTest)
+
+#include "main.moc"
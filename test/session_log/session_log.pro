@@ -0,0 +1,13 @@
+QT       += core gui
+
+TARGET = session_log
+CONFIG   += console qtestlib
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src/transport
+
+HEADERS += ../../src/transport/session_log.h
+SOURCES += main.cpp \
+           ../../src/transport/session_log.cpp
@@ -0,0 +1,169 @@
+#include <QtTest/QTest>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QEventLoop>
+#include <QTimer>
+
+#include "torrent_search.h"
+
+QByteArray row(int n)
+{
+    return QString("<tr><td><div class=\"text\"><a href=\"/torrent/%1\">Movie &amp; track %1</a></div>"
+                   "<div class=\"magnet\"><a href=\"magnet:?xt=urn:btih:%1\">m</a></div>"
+                   "<div class=\"date\">Video</div></td>"
+                   "<td><div class=\" col-3\">%2 MB</div></td>"
+                   "<td><div class=\" col-4\">%3</div></td>"
+                   "<td><div class=\" col-5\">%4</div></td>"
+                   "<td><div class=\" col-6\"><span title=\"site%5\"></span></div></td></tr>\n")
+           .arg(n).arg(n % 1000 + 1).arg(n % 50).arg(n % 7).arg(n % 3).toUtf8();
+}
+
+QByteArray page(int rows)
+{
+    QByteArray res = "<!DOCTYPE html><html><head><meta charset=\"utf-8\">"
+                     "<script>var s = '<table id=\"res_table\"><tr>';</script></head><body>"
+                     "<table id=\"other\"><tr><td><div class=\"text\"><a href=\"/no\">no</a></div></td></tr></table>"
+                     "<table id=\"res_table\"><thead><tr><th>Name</th></tr></thead><tbody>\n";
+
+    for (int i = 0; i < rows; ++i)
+        res += row(i);
+
+    // row without end tag is closed by table end
+    res += "<tr><td><div class=\"text\"><a href=\"/torrent/last\">Last<br/>one</a></div>"
+           "<div class=\" col-3\">1.5 GB</div></tbody></table></body></html>";
+    return res;
+}
+
+// answers any request with redirect to /results and /results with page
+class StandInServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    StandInServer(int rows) : m_page(page(rows))
+    {
+        connect(this, SIGNAL(newConnection()), SLOT(on_newConnection()));
+    }
+private slots:
+    void on_newConnection()
+    {
+        while (QTcpSocket* socket = nextPendingConnection())
+            connect(socket, SIGNAL(readyRead()), SLOT(on_readyRead()));
+    }
+
+    void on_readyRead()
+    {
+        QTcpSocket* socket = static_cast<QTcpSocket*>(sender());
+        QByteArray request = socket->readAll();
+        QByteArray answer;
+
+        if (request.startsWith("GET /results"))
+        {
+            answer = "HTTP/1.0 200 OK\r\nContent-Type: text/html; charset=utf-8\r\nContent-Length: " +
+                QByteArray::number(m_page.size()) + "\r\n\r\n" + m_page;
+        }
+        else
+        {
+            answer = "HTTP/1.0 302 Found\r\nLocation: /results\r\nContent-Length: 0\r\n\r\n";
+        }
+
+        socket->write(answer);
+        socket->disconnectFromHost();
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+private:
+    QByteArray m_page;
+};
+
+class Receiver : public QObject
+{
+    Q_OBJECT
+public:
+    bool m_ok;
+    QList<TorrentSearchRow> m_rows;
+public slots:
+    void on_finished(bool ok, const QList<TorrentSearchRow>& rows)
+    {
+        m_ok = ok;
+        m_rows = rows;
+        emit done();
+    }
+signals:
+    void done();
+};
+
+// QCOMPARE returns from helper only, callers check QTest::currentTestFailed()
+void check(const QList<TorrentSearchRow>& rows, int count, const QString& base)
+{
+    QCOMPARE(rows.size(), count + 1);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const TorrentSearchRow& r = rows.at(i);
+        QCOMPARE(r.m_name, QString("Movie & track %1").arg(i));
+        QCOMPARE(r.m_url, base + QString("/torrent/%1").arg(i));
+        QCOMPARE(r.m_magnet, QString("magnet:?xt=urn:btih:%1").arg(i));
+        QCOMPARE(r.m_type, QString("Video"));
+        QCOMPARE(r.m_size, qulonglong(i % 1000 + 1) * 1000 * 1000);
+        QCOMPARE(r.m_seeders, i % 50);
+        QCOMPARE(r.m_leechers, i % 7);
+        QCOMPARE(r.m_site, QString("site%1").arg(i % 3));
+    }
+
+    // row without end tag is closed by table end
+    QCOMPARE(rows.last().m_name, QString("Lastone"));
+    QCOMPARE(rows.last().m_size, qulonglong(1500000000ull));
+}
+
+class TorrentSearchTest : public QObject
+{
+    Q_OBJECT
+private slots:
+    void parse_data()
+    {
+        QTest::addColumn<int>("count");
+        QTest::newRow("empty") << 0;
+        QTest::newRow("small") << 100;
+        QTest::newRow("large") << 10000;
+    }
+
+    void parse()
+    {
+        QFETCH(int, count);
+        QByteArray data = page(count);
+        QList<TorrentSearchRow> rows;
+
+        QBENCHMARK_ONCE { rows = parseTorrtillaPage(data, QUrl("http://localhost")); }
+        check(rows, count, "http://localhost");
+    }
+
+    void standInServer()
+    {
+        StandInServer server(50);
+        QVERIFY(server.listen(QHostAddress::LocalHost));
+        QString base = QString("http://127.0.0.1:%1").arg(server.serverPort());
+
+        TorrtillaSearch search(base + "/torrents/0/");
+        Receiver receiver;
+        receiver.m_ok = false;
+        QObject::connect(&search, SIGNAL(finished(bool, const QList<TorrentSearchRow>&)),
+                         &receiver, SLOT(on_finished(bool, const QList<TorrentSearchRow>&)));
+
+        QEventLoop loop;
+        QObject::connect(&receiver, SIGNAL(done()), &loop, SLOT(quit()));
+        QTimer timer;
+        timer.setSingleShot(true);
+        QObject::connect(&timer, SIGNAL(timeout()), &loop, SLOT(quit()));
+        timer.start(10000);
+
+        search.search("movie");
+        loop.exec();
+
+        QVERIFY2(timer.isActive(), "search timed out");
+        QVERIFY(receiver.m_ok);
+        check(receiver.m_rows, 50, base);
+    }
+};
+
+QTEST_MAIN(TorrentSearchTest)
+
+#include "main.moc"
@@ -0,0 +1,15 @@
+QT       += core network
+
+QT       -= gui
+
+TARGET = torrent_search
+CONFIG   += console qtestlib
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+INCLUDEPATH += ../../src
+
+HEADERS += ../../src/torrent_search.h
+SOURCES += main.cpp \
+           ../../src/torrent_search.cpp